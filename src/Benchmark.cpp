@@ -0,0 +1,393 @@
+#include "Benchmark.hpp"
+#include <chrono>
+#include <random>
+#include <thread>
+#include "SlidingAttacks.hpp"
+#include "Perft.hpp"
+#include "EpdFile.hpp"
+#include "PackedPositionFile.hpp"
+#include "Search.hpp"
+
+namespace Benchmark {
+
+    void SlidingAttacks() {
+
+        using namespace SlidingAttacks;
+
+        // The same random occupancies are used for every backend. Sparse boards look more
+        // like real positions than uniformly random ones
+        std::mt19937_64 rng(20240601);
+        std::vector<uint64_t> occupancies(1 << 16);
+        for (auto &occupancy : occupancies)
+            occupancy = rng() & rng();
+
+        const int repetitions = 200;
+        Backend originalBackend = GetBackend();
+
+        std::vector<Backend> backends = {Backend::MAGIC};
+        if (HasBmi2())
+            backends.push_back(Backend::PEXT);
+        else
+            std::cout << "pext: skipped, CPU has no BMI2" << std::endl;
+
+        for (Backend backend : backends) {
+
+            SetBackend(backend);
+
+            // Accumulate the results so the compiler cannot drop the lookups
+            uint64_t checksum = 0ULL;
+            auto start = std::chrono::steady_clock::now();
+
+            for (int repetition = 0; repetition < repetitions; repetition++) {
+                for (size_t i = 0; i < occupancies.size(); i++) {
+                    int squareIdx = (i + repetition) & 63;
+                    checksum += GetRookAttacks(squareIdx, occupancies[i]);
+                    checksum += GetBishopAttacks(squareIdx, occupancies[i]);
+                }
+            }
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double lookups = 2.0 * repetitions * occupancies.size();
+
+            std::cout << (backend == Backend::PEXT ? "pext " : "magic")
+                      << ": " << static_cast<uint64_t>(lookups / elapsed.count()) << " attacks/sec"
+                      << " (checksum " << std::hex << checksum << std::dec << ")" << std::endl;
+        }
+
+        SetBackend(originalBackend);
+    }
+
+
+    void UndoStrategies() {
+
+        using Perft::UndoStrategy;
+
+        // Openings, middlegames and endgames weigh the cost of copying against that of undoing differently
+        const std::vector<std::pair<std::string, int>> positions = {
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5},
+            {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4},
+            {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6}
+        };
+
+        for (UndoStrategy strategy : {UndoStrategy::COPY_MAKE, UndoStrategy::MAKE_UNMAKE}) {
+
+            uint64_t nodes = 0;
+            auto start = std::chrono::steady_clock::now();
+
+            for (const auto &[fen, depth] : positions) {
+                Position position;
+                position.SetFromFen(fen);
+                nodes += (strategy == UndoStrategy::COPY_MAKE) ? Perft::CountNodes<UndoStrategy::COPY_MAKE>(position, depth)
+                                                               : Perft::CountNodes<UndoStrategy::MAKE_UNMAKE>(position, depth);
+            }
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << (strategy == UndoStrategy::COPY_MAKE ? "copy-make  " : "make/unmake")
+                      << ": " << static_cast<uint64_t>(nodes / elapsed.count()) << " nodes/sec"
+                      << " (" << nodes << " nodes in " << elapsed.count() << " s)"
+                      << (strategy == Perft::DEFAULT_UNDO_STRATEGY ? ", built-in default" : "") << std::endl;
+        }
+    }
+
+
+    void FenParsing() {
+
+        std::vector<std::string> fens;
+        for (const Perft::TestPosition &test : Perft::GetTestPositions())
+            fens.push_back(test.fen);
+
+        const int repetitions = 100000;
+        Position position;
+        uint64_t checksum = 0ULL;
+        size_t failures = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int repetition = 0; repetition < repetitions; repetition++) {
+            for (const std::string &fen : fens) {
+                failures += (position.ParseFen(fen) != FenError::NONE);
+                checksum += position.GetKey();
+            }
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double parsed = static_cast<double>(repetitions) * fens.size();
+
+        std::cout << "fen: " << static_cast<uint64_t>(parsed / elapsed.count()) << " FENs/sec"
+                  << " (" << failures << " failures, checksum " << std::hex << checksum << std::dec << ")" << std::endl;
+
+        // Writing goes into one reused buffer, and every written FEN must give back the one parsed
+        std::vector<Position> parsedPositions(fens.size());
+        char buffer[Position::MAX_FEN_SIZE];
+        size_t mismatches = 0;
+
+        for (size_t i = 0; i < fens.size(); i++) {
+            parsedPositions[i].SetFromFen(fens[i]);
+            mismatches += fens[i] != std::string(buffer, parsedPositions[i].WriteFen(buffer, sizeof(buffer)));
+        }
+
+        size_t written = 0;
+        start = std::chrono::steady_clock::now();
+
+        for (int repetition = 0; repetition < repetitions; repetition++)
+            for (const Position &parsedPosition : parsedPositions)
+                written += parsedPosition.WriteFen(buffer, sizeof(buffer));
+
+        elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "fen write: " << static_cast<uint64_t>(parsed / elapsed.count()) << " FENs/sec"
+                  << " (" << written << " characters, " << mismatches << " round trip mismatches)" << std::endl;
+
+        // Boards the move generator cannot be trusted with, each of which must be rejected for the right reason
+        const std::vector<std::pair<std::string, FenError>> rejections = {
+            {"4k3/8/8/8/8/8/8/K3R3 w - - 0 1", FenError::OPPONENT_IN_CHECK},
+            {"4k3/8/8/4P3/8/8/8/4K3 w - d6 0 1", FenError::BAD_EN_PASSANT},
+            {"4k3/3p4/8/3pP3/8/8/8/4K3 w - d6 0 1", FenError::BAD_EN_PASSANT},
+            {"krQQQQQQ/ppQ4Q/QQ5Q/Q6Q/Q6Q/Q6Q/Q6Q/QQQQQQQK w - - 0 1", FenError::BAD_MATERIAL},
+            {"4k3/pppppppp/p7/8/8/8/8/4K3 w - - 0 1", FenError::BAD_MATERIAL},
+            {"qqqqk3/pppppp2/8/8/8/8/8/4K3 w - - 0 1", FenError::BAD_MATERIAL},
+        };
+
+        size_t wrongRejections = 0;
+        for (const auto &[fen, expected] : rejections) {
+            FenError error = position.ParseFen(fen);
+            if (error != expected) {
+                wrongRejections++;
+                std::cout << "expected \"" << Position::GetFenErrorName(expected) << "\" but got \""
+                          << Position::GetFenErrorName(error) << "\": " << fen << std::endl;
+            }
+        }
+
+        std::cout << "fen rejection: " << rejections.size() - wrongRejections << " of " << rejections.size()
+                  << " bad FENs rejected for the right reason" << std::endl;
+    }
+
+
+    bool SearchScaling(int depth, int maxThreads, int hashMB) {
+
+        if (depth <= 0)
+            return false;
+
+        const auto &tests = Perft::GetTestPositions();
+        const size_t positionCount = std::min<size_t>(tests.size(), 7);
+
+        SearchLimits limits;
+        limits.depth = depth;
+
+        TranspositionTable table(hashMB);
+        std::vector<Move> singleThreadMoves;
+        double singleThreadTime = 0.0;
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+
+        for (int threadCount = 1; threadCount <= std::max(maxThreads, 1); threadCount *= 2) {
+
+            uint64_t nodes = 0;
+            double seconds = 0.0;
+            int sameMoves = 0;
+
+            for (size_t i = 0; i < positionCount; i++) {
+
+                Position position;
+                position.SetFromFen(tests[i].fen);
+                table.Clear();
+                SearchResult result = Search(position, limits, table, threadCount);
+
+                nodes += result.nodes;
+                seconds += result.seconds;
+
+                if (threadCount == 1)
+                    singleThreadMoves.push_back(result.bestMove);
+                sameMoves += (result.bestMove == singleThreadMoves[i]);
+            }
+
+            if (threadCount == 1)
+                singleThreadTime = seconds;
+
+            std::cout << "threads " << threadCount << ": depth " << depth << " in " << seconds << " s, speedup "
+                      << singleThreadTime / std::max(seconds, 1e-9) << "x, " << nodes << " nodes, "
+                      << static_cast<uint64_t>(nodes / std::max(seconds, 1e-9)) << " nodes/sec, "
+                      << sameMoves << "/" << positionCount << " best moves as with 1 thread"
+                      << (cores > 0 && threadCount > cores ? " (more threads than cores)" : "") << std::endl;
+        }
+
+        // Helpers also widen the search, which time to depth does not see, and a stronger
+        // search only shows in games
+        std::cout << "Elo scaling is not measured: it needs matches between thread counts at a fixed time control" << std::endl;
+
+        return true;
+    }
+
+
+    bool EpdLoading(const std::string &path, int maxThreads) {
+
+        EpdFile file;
+        double serialTime = 0.0;
+
+        for (int threadCount = 1; threadCount <= std::max(maxThreads, 1); threadCount *= 2) {
+
+            auto start = std::chrono::steady_clock::now();
+            if (!file.Load(path, threadCount)) {
+                std::cerr << "Could not read " << path << std::endl;
+                return false;
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (threadCount == 1)
+                serialTime = elapsed;
+
+            std::cout << "threads " << threadCount << ": " << file.GetCount() << " positions in " << elapsed << " s, "
+                      << static_cast<uint64_t>(file.GetCount() / std::max(elapsed, 1e-9)) << " positions/sec, speedup "
+                      << serialTime / std::max(elapsed, 1e-9) << "x" << std::endl;
+        }
+
+        const size_t maxErrorsShown = 10;
+        const auto &errors = file.GetErrors();
+
+        for (size_t i = 0; i < std::min(errors.size(), maxErrorsShown); i++)
+            std::cout << "line " << errors[i].first << ": " << Position::GetFenErrorName(errors[i].second) << std::endl;
+
+        if (!errors.empty())
+            std::cout << errors.size() << " lines could not be parsed" << std::endl;
+
+        return true;
+    }
+
+
+    bool PackedPositions(const std::string &epdPath, const std::string &outputPath, int threadCount) {
+
+        EpdFile epdFile;
+        if (!epdFile.Load(epdPath, threadCount)) {
+            std::cerr << "Could not read " << epdPath << std::endl;
+            return false;
+        }
+
+        size_t count = epdFile.GetCount();
+        std::vector<PackedPosition> records(count);
+        size_t packedCount = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < count; i++)
+            packedCount += epdFile.GetPosition(i).ToPacked(records[packedCount]);
+
+        double encodeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Positions with too many pieces to pack were skipped, so match the records up with their sources again
+        std::vector<size_t> sources;
+        for (size_t i = 0; i < count; i++) {
+            PackedPosition unused;
+            if (epdFile.GetPosition(i).ToPacked(unused))
+                sources.push_back(i);
+        }
+
+        if (!PackedPositionFile::Write(outputPath, records.data(), packedCount)) {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return false;
+        }
+
+        PackedPositionFile packedFile;
+        if (!packedFile.Open(outputPath)) {
+            std::cerr << "Could not map " << outputPath << " back in" << std::endl;
+            return false;
+        }
+
+        // Decoding is timed on its own; the FEN comparison afterwards is only a check
+        std::vector<Position> decoded(packedFile.GetCount());
+        size_t invalid = 0;
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packedFile.GetCount(); i++)
+            invalid += !decoded[i].SetFromPacked(packedFile.GetRecords()[i]);
+        double decodeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t mismatches = invalid;
+        for (size_t i = 0; i < packedFile.GetCount(); i++)
+            mismatches += decoded[i].ToFen() != epdFile.GetPosition(sources[i]).ToFen();
+
+        // A mapped file is untrusted, so a record with more material than promotions allow must not
+        // decode: black king on a8, white king on h1 and 30 white queens on the squares from a6 on
+        PackedPosition overMaterial {};
+        overMaterial.occupancy = (1ULL << 0) | (((1ULL << 30) - 1) << 16) | (1ULL << 63);
+        overMaterial.pieces[0] = B_KING;
+        for (int pieceIdx = 1; pieceIdx <= 30; pieceIdx++)
+            overMaterial.pieces[pieceIdx / 2] |= W_QUEEN << (4 * (pieceIdx % 2));
+        overMaterial.pieces[15] |= W_KING << 4;
+        overMaterial.fullMove = 1;
+        overMaterial.flags = BLACK;
+        overMaterial.enPassantFile = 8;
+
+        Position overMaterialPosition;
+        bool isOverMaterialRejected = !overMaterialPosition.SetFromPacked(overMaterial);
+
+        std::cout << packedFile.GetCount() << " positions, " << sizeof(PackedPosition) << " bytes each ("
+                  << count - packedCount << " skipped with more than " << PackedPosition::MAX_PIECES << " pieces)" << std::endl
+                  << "encode: " << static_cast<uint64_t>(count / std::max(encodeTime, 1e-9)) << " positions/sec" << std::endl
+                  << "decode: " << static_cast<uint64_t>(packedFile.GetCount() / std::max(decodeTime, 1e-9)) << " positions/sec" << std::endl
+                  << "round trip: " << (mismatches ? std::to_string(mismatches) + " positions differ" : "every FEN matches") << std::endl
+                  << "validation: a record with 30 queens is " << (isOverMaterialRejected ? "rejected" : "accepted") << std::endl;
+
+        return mismatches == 0 && isOverMaterialRejected;
+    }
+
+
+    void Searching() {
+
+        // The first seven test positions are from real games; the rest are move generation edge cases
+        const auto &tests = Perft::GetTestPositions();
+        const int depth = 5;
+        const size_t positionCount = std::min<size_t>(tests.size(), 7);
+
+        SearchLimits limits;
+        limits.depth = depth;
+
+        // Cleared for every position, so each search is timed from the same cold start
+        TranspositionTable table(DEFAULT_HASH_MB);
+        uint64_t nodes = 0;
+        uint64_t ttProbes = 0;
+        uint64_t ttHits = 0;
+        uint64_t cutoffs = 0;
+        uint64_t firstMoveCutoffs = 0;
+        double seconds = 0.0;
+
+        for (size_t i = 0; i < positionCount; i++) {
+
+            Position position;
+            position.SetFromFen(tests[i].fen);
+            table.Clear();
+            SearchResult result = Search(position, limits, table);
+
+            nodes += result.nodes;
+            ttProbes += result.ttProbes;
+            ttHits += result.ttHits;
+            cutoffs += result.cutoffs;
+            firstMoveCutoffs += result.firstMoveCutoffs;
+            seconds += result.seconds;
+
+            std::cout << tests[i].name << ": " << result.bestMove.ToString() << " " << FormatScore(result.score)
+                      << ", " << result.nodes << " nodes" << std::endl;
+        }
+
+        std::cout << "search: " << static_cast<uint64_t>(nodes / std::max(seconds, 1e-9)) << " nodes/sec"
+                  << " (" << nodes << " nodes to depth " << depth << " in " << seconds << " s, hash hit rate "
+                  << 100.0 * ttHits / std::max<uint64_t>(ttProbes, 1) << "%, first-move cutoffs "
+                  << 100.0 * firstMoveCutoffs / std::max<uint64_t>(cutoffs, 1) << "%)" << std::endl;
+    }
+
+
+    bool Run(const std::string &name) {
+
+        if (name == "sliders")
+            SlidingAttacks();
+        else if (name == "undo")
+            UndoStrategies();
+        else if (name == "fen")
+            FenParsing();
+        else if (name == "search")
+            Searching();
+        else
+            return false;
+
+        return true;
+    }
+}
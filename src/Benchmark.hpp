@@ -0,0 +1,43 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Headless micro-benchmarks, run from the command line with "main bench <name>"
+namespace Benchmark {
+
+    // Reports rook + bishop attack lookups per second for each sliding-attack backend
+    void SlidingAttacks();
+
+    // Reports single-threaded perft nodes/sec with copy-make and with make/unmake, over a few
+    // test positions, so the faster way of taking back moves on this machine can be built in
+    void UndoStrategies();
+
+    // Reports FEN strings parsed and written per second, cycling through the perft test positions
+    void FenParsing();
+
+    // Searches the game positions among the perft test positions to a fixed depth and reports
+    // the best moves, the node counts and the nodes/sec over all of them
+    void Searching();
+
+    // Searches the same game positions to depth with 1, 2, 4, ... threads up to maxThreads, each
+    // position from an empty table of hashMB, and prints the time to depth, its speedup over one
+    // thread, the nodes/sec and how many best moves agree with one thread's. Returns false if
+    // depth is not positive
+    bool SearchScaling(int depth, int maxThreads, int hashMB);
+
+    // Loads the EPD or FEN file at path with 1, 2, 4, ... threads up to maxThreads, printing the
+    // load time and positions/sec of each, then any lines that failed to parse. Returns false
+    // if the file cannot be read
+    bool EpdLoading(const std::string &path, int maxThreads);
+
+    // Converts the EPD or FEN file at epdPath into a PackedPositionFile at outputPath, maps it
+    // back in and checks every record decodes to the same FEN, printing the sizes and the
+    // encode and decode rates. Returns false if a file cannot be read or written or a record differs
+    bool PackedPositions(const std::string &epdPath, const std::string &outputPath, int threadCount);
+
+    // Runs the benchmark called name. Returns false if there is no such benchmark
+    bool Run(const std::string &name);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Small bit-twiddling helpers shared by move generation and the position
+namespace Bitboard {
+
+    // Number of set bits
+    inline int CountBits(uint64_t bitboard) {
+        return __builtin_popcountll(bitboard);
+    }
+
+    // Index of the lowest set bit. bitboard must not be empty
+    inline int GetLsbIdx(uint64_t bitboard) {
+        return __builtin_ctzll(bitboard);
+    }
+
+    // Clears the lowest set bit and returns its index. bitboard must not be empty
+    inline int PopLsb(uint64_t &bitboard) {
+        int idx = __builtin_ctzll(bitboard);
+        bitboard &= bitboard - 1;
+        return idx;
+    }
+
+    // True if more than one bit is set
+    inline bool HasMoreThanOne(uint64_t bitboard) {
+        return (bitboard & (bitboard - 1)) != 0ULL;
+    }
+}
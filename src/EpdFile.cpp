@@ -0,0 +1,223 @@
+#include "EpdFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include "ThreadPool.hpp"
+
+static bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+
+// Removes and returns the next whitespace-separated token of text, or an empty view if there is none
+static std::string_view NextToken(std::string_view &text) {
+
+    size_t start = 0;
+    while (start < text.size() && IsSpace(text[start]))
+        start++;
+
+    size_t end = start;
+    while (end < text.size() && !IsSpace(text[end]))
+        end++;
+
+    std::string_view token = text.substr(start, end - start);
+    text.remove_prefix(end);
+
+    return token;
+}
+
+
+static std::string_view Trim(std::string_view text) {
+
+    while (!text.empty() && IsSpace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && IsSpace(text.back()))
+        text.remove_suffix(1);
+
+    return text;
+}
+
+
+EpdFile::EpdFile() : count(0) {}
+
+
+std::pair<std::string_view, std::string_view> EpdFile::SplitLine(std::string_view line) {
+
+    std::string_view rest = line;
+
+    for (int field = 0; field < 4; field++)
+        NextToken(rest);
+
+    // FEN lines go on to the two move clocks, where EPD lines have operations instead
+    for (int clock = 0; clock < 2; clock++) {
+
+        std::string_view afterClock = rest;
+        std::string_view token = NextToken(afterClock);
+
+        if (token.empty() || !std::all_of(token.begin(), token.end(), [](char c) {return c >= '0' && c <= '9';}))
+            break;
+
+        rest = afterClock;
+    }
+
+    return {line.substr(0, line.size() - rest.size()), Trim(rest)};
+}
+
+
+std::string_view EpdFile::FindOperand(std::string_view operations, std::string_view opcode) {
+
+    while (!operations.empty()) {
+
+        // Each operation ends at a semicolon, unless the semicolon is inside a quoted string
+        size_t end = 0;
+        bool isQuoted = false;
+
+        while (end < operations.size() && (operations[end] != ';' || isQuoted)) {
+            if (operations[end] == '"')
+                isQuoted = !isQuoted;
+            end++;
+        }
+
+        std::string_view operation = operations.substr(0, end);
+        operations.remove_prefix(std::min(end + 1, operations.size()));
+
+        if (NextToken(operation) == opcode) {
+            std::string_view operand = Trim(operation);
+            if (operand.size() >= 2 && operand.front() == '"' && operand.back() == '"')
+                operand = operand.substr(1, operand.size() - 2);
+            return operand;
+        }
+    }
+
+    return {};
+}
+
+
+bool EpdFile::Load(const std::string &path, int threadCount) {
+
+    positions.reset();
+    operations.clear();
+    errors.clear();
+    count = 0;
+
+    if (!file.Open(path))
+        return false;
+
+    const char *data = file.GetData();
+    size_t size = file.GetSize();
+
+    if (size == 0)
+        return true;
+
+    /* CHUNKING */
+    // Several chunks per thread, so that a thread given short lines can steal work from the others.
+    // Every chunk starts at the beginning of a line
+    threadCount = std::max(threadCount, 1);
+    size_t chunkCount = std::min<size_t>(threadCount * 8, size);
+    std::vector<size_t> chunkStarts = {0};
+
+    for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+        size_t start = std::max(size * chunk / chunkCount, chunkStarts.back());
+        const char *newline = static_cast<const char *>(std::memchr(data + start, '\n', size - start));
+        start = newline ? newline - data + 1 : size;
+
+        if (start > chunkStarts.back() && start < size)
+            chunkStarts.push_back(start);
+    }
+
+    chunkCount = chunkStarts.size();
+    chunkStarts.push_back(size);
+
+    // Calls handleLine(line) for every line of the chunk, without its newline
+    auto ForEachLine = [data, &chunkStarts](size_t chunk, auto &&handleLine) {
+        const char *cursor = data + chunkStarts[chunk];
+        const char *end = data + chunkStarts[chunk + 1];
+
+        while (cursor < end) {
+            const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+            const char *lineEnd = newline ? newline : end;
+            handleLine(std::string_view(cursor, lineEnd - cursor));
+            cursor = lineEnd + 1;
+        }
+    };
+
+    ThreadPool pool(threadCount);
+
+    /* COUNTING */
+    // First count the lines and non-blank lines of each chunk, to find where each chunk's
+    // positions start in the shared array and which line number each chunk starts on
+    std::vector<size_t> chunkLines(chunkCount + 1, 0);
+    std::vector<size_t> chunkEntries(chunkCount + 1, 0);
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        pool.Submit([&, chunk] {
+            ForEachLine(chunk, [&](std::string_view line) {
+                chunkLines[chunk + 1]++;
+                chunkEntries[chunk + 1] += !Trim(line).empty();
+            });
+        });
+    }
+
+    pool.Wait();
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        chunkLines[chunk + 1] += chunkLines[chunk];
+        chunkEntries[chunk + 1] += chunkEntries[chunk];
+    }
+
+    size_t entryCount = chunkEntries[chunkCount];
+    positions.reset(static_cast<Position *>(::operator new[](std::max<size_t>(entryCount, 1) * sizeof(Position),
+                                                             std::align_val_t(alignof(Position)))));
+    operations.resize(entryCount);
+
+    /* PARSING */
+    // Each chunk writes only to its own range of slots, so no locking is needed
+    std::vector<uint8_t> isParsed(entryCount, 0);
+    std::vector<std::vector<std::pair<size_t, FenError>>> chunkErrors(chunkCount);
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        pool.Submit([&, chunk] {
+            Position position;
+            size_t lineNumber = chunkLines[chunk];
+            size_t entry = chunkEntries[chunk];
+
+            ForEachLine(chunk, [&](std::string_view line) {
+                lineNumber++;
+                if (Trim(line).empty())
+                    return;
+
+                auto [fen, lineOperations] = SplitLine(line);
+                FenError error = position.ParseFen(fen);
+
+                if (error == FenError::NONE) {
+                    new (&positions[entry]) Position(position);
+                    operations[entry] = lineOperations;
+                    isParsed[entry] = 1;
+                }
+                else
+                    chunkErrors[chunk].emplace_back(lineNumber, error);
+
+                entry++;
+            });
+        });
+    }
+
+    pool.Wait();
+
+    // Close the gaps left by lines that failed to parse
+    for (size_t entry = 0; entry < entryCount; entry++) {
+        if (isParsed[entry]) {
+            if (count != entry) {
+                new (&positions[count]) Position(positions[entry]);
+                operations[count] = operations[entry];
+            }
+            count++;
+        }
+    }
+
+    operations.resize(count);
+
+    for (const auto &errorList : chunkErrors)
+        errors.insert(errors.end(), errorList.begin(), errorList.end());
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Position.hpp"
+
+// An EPD or FEN file, memory-mapped and parsed in parallel into one contiguous array of
+// positions. Each line is a position, optionally followed by move clocks or by EPD operations
+// such as bm, id or c0. The operations are kept as views into the mapping, so nothing is
+// allocated per line, and they stay valid for as long as the EpdFile does
+class EpdFile {
+
+    public:
+        EpdFile();
+
+        EpdFile(const EpdFile &) = delete;
+        EpdFile &operator=(const EpdFile &) = delete;
+
+        // Maps the file at path and parses it on threadCount threads, replacing anything loaded before.
+        // Returns false if the file cannot be opened or mapped. Lines that fail to parse are
+        // skipped and listed in GetErrors()
+        bool Load(const std::string &path, int threadCount);
+
+        size_t GetCount() const {return count;}
+        const Position &GetPosition(size_t idx) const {return positions[idx];}
+
+        // Everything on the line after the position, e.g. "bm e4; id \"test 1\";"
+        std::string_view GetOperations(size_t idx) const {return operations[idx];}
+
+        // Line number, from 1, and error of every line that could not be parsed
+        const std::vector<std::pair<size_t, FenError>> &GetErrors() const {return errors;}
+
+        // The operand of opcode in operations without its quotes, e.g. "test 1" for opcode "id"
+        // above, or an empty view if opcode is not there
+        static std::string_view FindOperand(std::string_view operations, std::string_view opcode);
+
+    private:
+        // Splits line into the FEN, clocks included, and the operations after it
+        static std::pair<std::string_view, std::string_view> SplitLine(std::string_view line);
+
+    private:
+        // Positions are over-aligned, so their storage comes from aligned new. It is left
+        // unconstructed, as Position is trivially copyable and every slot is copied into
+        struct AlignedDelete {
+            void operator()(Position *storage) const {::operator delete[](storage, std::align_val_t(alignof(Position)));}
+        };
+
+        std::unique_ptr<Position[], AlignedDelete> positions;
+        std::vector<std::string_view> operations;
+        std::vector<std::pair<size_t, FenError>> errors;
+        size_t count;
+
+        // The operations point into the mapping, so it is kept open
+        MappedFile file;
+};
@@ -0,0 +1,130 @@
+#include "Evaluation.hpp"
+#include <algorithm>
+#include "Bitboard.hpp"
+
+namespace Evaluation {
+
+    using Table = std::array<int, 64>;
+
+    // Bonuses for White, laid out like a FEN from a8 to h1, so a white piece on squareIdx reads
+    // table[squareIdx] and a black one reads the vertically mirrored square, squareIdx ^ 56
+    constexpr Table pawnTable = {
+         0,   0,   0,   0,   0,   0,   0,   0,
+        50,  50,  50,  50,  50,  50,  50,  50,
+        10,  10,  20,  30,  30,  20,  10,  10,
+         5,   5,  10,  25,  25,  10,   5,   5,
+         0,   0,   0,  20,  20,   0,   0,   0,
+         5,  -5, -10,   0,   0, -10,  -5,   5,
+         5,  10,  10, -20, -20,  10,  10,   5,
+         0,   0,   0,   0,   0,   0,   0,   0
+    };
+
+    constexpr Table rookTable = {
+         0,   0,   0,   0,   0,   0,   0,   0,
+         5,  10,  10,  10,  10,  10,  10,   5,
+        -5,   0,   0,   0,   0,   0,   0,  -5,
+        -5,   0,   0,   0,   0,   0,   0,  -5,
+        -5,   0,   0,   0,   0,   0,   0,  -5,
+        -5,   0,   0,   0,   0,   0,   0,  -5,
+        -5,   0,   0,   0,   0,   0,   0,  -5,
+         0,   0,   0,   5,   5,   0,   0,   0
+    };
+
+    constexpr Table knightTable = {
+        -50, -40, -30, -30, -30, -30, -40, -50,
+        -40, -20,   0,   0,   0,   0, -20, -40,
+        -30,   0,  10,  15,  15,  10,   0, -30,
+        -30,   5,  15,  20,  20,  15,   5, -30,
+        -30,   0,  15,  20,  20,  15,   0, -30,
+        -30,   5,  10,  15,  15,  10,   5, -30,
+        -40, -20,   0,   5,   5,   0, -20, -40,
+        -50, -40, -30, -30, -30, -30, -40, -50
+    };
+
+    constexpr Table bishopTable = {
+        -20, -10, -10, -10, -10, -10, -10, -20,
+        -10,   0,   0,   0,   0,   0,   0, -10,
+        -10,   0,   5,  10,  10,   5,   0, -10,
+        -10,   5,   5,  10,  10,   5,   5, -10,
+        -10,   0,  10,  10,  10,  10,   0, -10,
+        -10,  10,  10,  10,  10,  10,  10, -10,
+        -10,   5,   0,   0,   0,   0,   5, -10,
+        -20, -10, -10, -10, -10, -10, -10, -20
+    };
+
+    constexpr Table queenTable = {
+        -20, -10, -10,  -5,  -5, -10, -10, -20,
+        -10,   0,   0,   0,   0,   0,   0, -10,
+        -10,   0,   5,   5,   5,   5,   0, -10,
+         -5,   0,   5,   5,   5,   5,   0,  -5,
+          0,   0,   5,   5,   5,   5,   0,  -5,
+        -10,   5,   5,   5,   5,   5,   0, -10,
+        -10,   0,   5,   0,   0,   0,   0, -10,
+        -20, -10, -10,  -5,  -5, -10, -10, -20
+    };
+
+    // The king hides behind its pawns while there are pieces to attack it, and heads for the centre once there are not
+    constexpr Table kingMiddlegameTable = {
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -20, -30, -30, -40, -40, -30, -30, -20,
+        -10, -20, -20, -20, -20, -20, -20, -10,
+         20,  20,   0,   0,   0,   0,  20,  20,
+         20,  30,  10,   0,   0,  10,  30,  20
+    };
+
+    constexpr Table kingEndgameTable = {
+        -50, -40, -30, -20, -20, -30, -40, -50,
+        -30, -20, -10,   0,   0, -10, -20, -30,
+        -30, -10,  20,  30,  30,  20, -10, -30,
+        -30, -10,  30,  40,  40,  30, -10, -30,
+        -30, -10,  30,  40,  40,  30, -10, -30,
+        -30, -10,  20,  30,  30,  20, -10, -30,
+        -30, -30,   0,   0,   0,   0, -30, -30,
+        -50, -30, -30, -30, -30, -30, -30, -50
+    };
+
+    // Indexed by PieceType, with the king left to its two tables
+    constexpr std::array<const Table *, 5> pieceTables = {&pawnTable, &rookTable, &knightTable, &bishopTable, &queenTable};
+
+    // How much each piece counts towards the middlegame, indexed by PieceType. The starting position adds up to MAX_PHASE
+    constexpr std::array<int, 6> phaseWeights = {0, 2, 1, 1, 4, 0};
+    constexpr int MAX_PHASE = 24;
+
+
+    int Evaluate(const Position &position) {
+
+        int score = 0;
+        int phase = 0;
+
+        for (int colour = WHITE; colour <= BLACK; colour++) {
+
+            int sign = (colour == WHITE) ? 1 : -1;
+            int mirror = (colour == WHITE) ? 0 : 56;
+
+            for (int type = PAWN; type < KING; type++) {
+
+                uint64_t pieces = position.GetPieces(static_cast<Colour>(colour), static_cast<PieceType>(type));
+                phase += phaseWeights[type] * Bitboard::CountBits(pieces);
+
+                while (pieces) {
+                    int squareIdx = Bitboard::PopLsb(pieces);
+                    score += sign * (pieceValues[type] + (*pieceTables[type])[squareIdx ^ mirror]);
+                }
+            }
+        }
+
+        // Promotions can take the phase past the starting total
+        phase = std::min(phase, MAX_PHASE);
+
+        for (int colour = WHITE; colour <= BLACK; colour++) {
+            int sign = (colour == WHITE) ? 1 : -1;
+            int kingSquare = position.GetKingSquare(static_cast<Colour>(colour)) ^ ((colour == WHITE) ? 0 : 56);
+            score += sign * (kingMiddlegameTable[kingSquare] * phase + kingEndgameTable[kingSquare] * (MAX_PHASE - phase)) / MAX_PHASE;
+        }
+
+        return (position.GetActiveColour() == WHITE) ? score : -score;
+    }
+}
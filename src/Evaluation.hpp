@@ -0,0 +1,15 @@
+#pragma once
+
+#include <array>
+#include "Position.hpp"
+
+// Static evaluation: material plus piece-square tables, with the king's table blended from
+// the middlegame one to the endgame one as pieces come off
+namespace Evaluation {
+
+    // Centipawn values indexed by PieceType. The king is never traded, so it is worth nothing here
+    constexpr std::array<int, 6> pieceValues = {100, 500, 320, 330, 900, 0};
+
+    // The position's score in centipawns from the point of view of the side to move
+    int Evaluate(const Position &position);
+}
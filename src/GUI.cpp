@@ -35,7 +35,6 @@ GUI::GUI() :
 
     LoadPieceTextures();
     InitialiseBoard();
-    InitialiseCharToTextureMap();
 }
 
 
@@ -66,25 +65,6 @@ std::array<int, 4> GUI::GetBoardDimensions() {
 }
 
 
-void GUI::InitialiseCharToTextureMap() {
-
-    charToTextureMap = {
-        {'P', pieceTextures[wP]}, 
-        {'R', pieceTextures[wR]}, 
-        {'N', pieceTextures[wN]}, 
-        {'B', pieceTextures[wB]}, 
-        {'Q', pieceTextures[wQ]}, 
-        {'K', pieceTextures[wK]},
-        {'p', pieceTextures[bP]}, 
-        {'r', pieceTextures[bR]}, 
-        {'n', pieceTextures[bN]}, 
-        {'b', pieceTextures[bB]}, 
-        {'q', pieceTextures[bQ]}, 
-        {'k', pieceTextures[bK]}
-    };
-}
-
-
 void GUI::InitialiseBoard() {
     
     sidePadding = topPadding = bottomPadding = 20;
@@ -186,42 +166,27 @@ void GUI::RenderBoard(int clickCount, int clickIdx, uint64_t possibleMoves) {
 }
 
 
-void GUI::RenderPieces(std::string &fenString) {
+void GUI::RenderPieces(const Position &position) {
 
-    int squareIdx = 0;
-    int x, y;
+    uint64_t occupancy = position.GetAllPieces();
 
-    for (auto &i : fenString) {
+    while (occupancy) {
 
-        if (i == ' ')
-            break;
-        
-        // Render the piece denoted by the character
-        else if (isalpha(i)) {
-            
-            x = squareIdx % 8;
-            y = squareIdx / 8;
+        int squareIdx = __builtin_ctzll(occupancy);
+        occupancy &= occupancy - 1;
 
-            // Render the right piece on the right square
-            SDL_RenderCopy(renderer, charToTextureMap[i], NULL, &boardDest[x][y]);
-            
-            squareIdx++;
-        }
-
-        // Move on if the character denotes one or multiple empty squares
-        else if (isdigit(i)) {
-            squareIdx += i - '0';
-        }
+        // Render the right piece on the right square
+        SDL_RenderCopy(renderer, pieceTextures[position.GetPieceOn(squareIdx)], NULL, &boardDest[squareIdx % 8][squareIdx / 8]);
     }
 }
 
 
-void GUI::RenderScreen(std::string &fenString, int clickCount, int clickIdx, uint64_t possibleMoves) {
+void GUI::RenderScreen(const Position &position, int clickCount, int clickIdx, uint64_t possibleMoves) {
 
     SDL_RenderClear(renderer);
 
     RenderBoard(clickCount, clickIdx, possibleMoves);
-    RenderPieces(fenString);
+    RenderPieces(position);
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
 
     SDL_RenderPresent(renderer);
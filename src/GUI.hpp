@@ -3,25 +3,24 @@
 #include <iostream>
 #include <array>
 #include <vector>
-#include <map>
 #include <cstdint>
 
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_image.h"
+#include "Position.hpp"
 
 class GUI {
     public:
         GUI();
         ~GUI();
 
-        void RenderScreen(std::string &fenString, int clickCount, int clickIdx, uint64_t possibleMoves);
+        void RenderScreen(const Position &position, int clickCount, int clickIdx, uint64_t possibleMoves);
 
         // Returns {x, y, w, h}
         std::array<int, 4> GetBoardDimensions();
 
     private:
         /* INITIALISATION FUNCTIONS */
-        void InitialiseCharToTextureMap();
         void InitialiseBoard();
         void LoadPieceTextures();
 
@@ -30,7 +29,7 @@ class GUI {
         void RenderBoard(int clickCount, int clickIdx, uint64_t possibleMoves);
 
         // Renders the pieces still present on the board
-        void RenderPieces(std::string &fenString);
+        void RenderPieces(const Position &position);
 
     private:
 
@@ -51,9 +50,8 @@ class GUI {
         std::array<SDL_Surface*, 12> pieceSurfaces;
         std::array<SDL_Texture*, 12> pieceTextures;
 
-        // enum relating to indices in pieceTextures, for ease of rendering where appropriate
+        // enum relating to indices in pieceTextures, in the same order as Piece so that
+        // pieceTextures can be indexed by the piece on a square
         enum pieceEnum {wP, wR, wN, wB, wQ, wK, bP, bR, bN, bB, bQ, bK};
-
-        // Maps FEN string characters to relevant textures
-        std::map<char, SDL_Texture*> charToTextureMap;
+        static_assert(static_cast<int>(bK) == B_KING, "pieceTextures must be in Piece order");
 };
\ No newline at end of file
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Attack tables for every square, built by the compiler so that nothing has to be
+// generated at startup. Square 0 is a8 and square 63 is h1, matching the FEN order.
+namespace LookupTables {
+
+    using Table = std::array<uint64_t, 64>;
+
+    // All of the theoretically possible moves with no constraints
+    enum moveDirection {UP = -8,
+                        DOWN = 8,
+                        LEFT = -1,
+                        RIGHT = 1,
+                        UP_LEFT = -9,
+                        UP_RIGHT = -7,
+                        DOWN_LEFT = 7,
+                        DOWN_RIGHT = 9};
+
+    constexpr uint64_t EMPTY_BITBOARD = 0ULL;
+
+    // Used to check whether the piece can move without going off the board
+    constexpr uint64_t AFile = 0b0000000100000001000000010000000100000001000000010000000100000001ULL;
+    constexpr uint64_t BFile = AFile << 1;
+    constexpr uint64_t CFile = BFile << 1;
+    constexpr uint64_t DFile = CFile << 1;
+    constexpr uint64_t EFile = DFile << 1;
+    constexpr uint64_t FFile = EFile << 1;
+    constexpr uint64_t GFile = FFile << 1;
+    constexpr uint64_t HFile = GFile << 1;
+
+    constexpr uint64_t Rank1 = 0b1111111100000000000000000000000000000000000000000000000000000000ULL;
+    constexpr uint64_t Rank2 = Rank1 >> 8;
+    constexpr uint64_t Rank3 = Rank2 >> 8;
+    constexpr uint64_t Rank4 = Rank3 >> 8;
+    constexpr uint64_t Rank5 = Rank4 >> 8;
+    constexpr uint64_t Rank6 = Rank5 >> 8;
+    constexpr uint64_t Rank7 = Rank6 >> 8;
+    constexpr uint64_t Rank8 = Rank7 >> 8;
+
+    constexpr uint64_t OuterEdge = AFile | HFile | Rank1 | Rank8;
+    constexpr uint64_t InnerEdge = BFile | GFile | Rank2 | Rank7;
+
+    // Sets the bit at idx to 1
+    constexpr void SetBit(uint64_t &bitBoard, int idx) {
+        bitBoard |= (1ULL << idx);
+    }
+
+
+    /* GENERATORS */
+    constexpr Table GenerateWhitePawnMoves() {
+
+        Table table {};
+
+        // This range used because rank 8 pawns get promoted, and pawns start on rank 2
+        for (int squareIdx = 8; squareIdx < 56; squareIdx++) {
+
+            uint64_t moveBitboard = EMPTY_BITBOARD;
+            bool isAFile = ((1ULL << squareIdx) & AFile);
+            bool isHFile = ((1ULL << squareIdx) & HFile);
+
+            SetBit(moveBitboard, squareIdx + UP);
+
+            // Rank 2 pawns can also move two squares
+            if (squareIdx >= 48)
+                SetBit(moveBitboard, squareIdx + 2 * UP);
+            if (!isAFile)
+                SetBit(moveBitboard, squareIdx + UP_LEFT);
+            if (!isHFile)
+                SetBit(moveBitboard, squareIdx + UP_RIGHT);
+
+            table[squareIdx] = moveBitboard;
+        }
+
+        return table;
+    }
+
+
+    constexpr Table GenerateBlackPawnMoves() {
+
+        Table table {};
+
+        // This range used because bottom rank can't move, and pawns start on rank 7
+        for (int squareIdx = 8; squareIdx < 56; squareIdx++) {
+
+            uint64_t moveBitboard = EMPTY_BITBOARD;
+            bool isAFile = ((1ULL << squareIdx) & AFile);
+            bool isHFile = ((1ULL << squareIdx) & HFile);
+
+            SetBit(moveBitboard, squareIdx + DOWN);
+
+            // Rank 7 pawns can also move two squares
+            if (squareIdx <= 15)
+                SetBit(moveBitboard, squareIdx + 2 * DOWN);
+            if (!isAFile)
+                SetBit(moveBitboard, squareIdx + DOWN_LEFT);
+            if (!isHFile)
+                SetBit(moveBitboard, squareIdx + DOWN_RIGHT);
+
+            table[squareIdx] = moveBitboard;
+        }
+
+        return table;
+    }
+
+
+    constexpr Table GenerateKnightMoves() {
+
+        Table table {};
+
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+
+            int file = squareIdx % 8;
+            int row = squareIdx / 8;
+            uint64_t moveBitboard = EMPTY_BITBOARD;
+
+            // {file offset, row offset} of each of the eight jumps
+            constexpr int jumps[8][2] = {{-1, -2}, {1, -2}, {-2, -1}, {2, -1},
+                                         {-2, 1}, {2, 1}, {-1, 2}, {1, 2}};
+
+            for (auto &jump : jumps) {
+
+                int targetFile = file + jump[0];
+                int targetRow = row + jump[1];
+
+                // Move has to stay on the board
+                if (targetFile >= 0 && targetFile < 8 && targetRow >= 0 && targetRow < 8)
+                    SetBit(moveBitboard, targetFile + targetRow * 8);
+            }
+
+            table[squareIdx] = moveBitboard;
+        }
+
+        return table;
+    }
+
+
+    constexpr Table GenerateKingMoves() {
+
+        Table table {};
+
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+
+            int file = squareIdx % 8;
+            int row = squareIdx / 8;
+            uint64_t moveBitboard = EMPTY_BITBOARD;
+
+            for (int fileStep = -1; fileStep <= 1; fileStep++) {
+                for (int rowStep = -1; rowStep <= 1; rowStep++) {
+
+                    int targetFile = file + fileStep;
+                    int targetRow = row + rowStep;
+
+                    if ((fileStep != 0 || rowStep != 0) &&
+                        targetFile >= 0 && targetFile < 8 && targetRow >= 0 && targetRow < 8)
+                    {
+                        SetBit(moveBitboard, targetFile + targetRow * 8);
+                    }
+                }
+            }
+
+            table[squareIdx] = moveBitboard;
+        }
+
+        return table;
+    }
+
+
+    // Rays from squareIdx in the direction {fileStep, rowStep} until the edge of the board
+    constexpr uint64_t GenerateRay(int squareIdx, int fileStep, int rowStep) {
+
+        uint64_t ray = EMPTY_BITBOARD;
+        int file = squareIdx % 8 + fileStep;
+        int row = squareIdx / 8 + rowStep;
+
+        while (file >= 0 && file < 8 && row >= 0 && row < 8) {
+            SetBit(ray, file + row * 8);
+            file += fileStep;
+            row += rowStep;
+        }
+
+        return ray;
+    }
+
+
+    constexpr Table GenerateBishopMoves() {
+
+        Table table {};
+
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+            table[squareIdx] = GenerateRay(squareIdx, -1, -1) | GenerateRay(squareIdx, 1, -1) |
+                               GenerateRay(squareIdx, -1, 1) | GenerateRay(squareIdx, 1, 1);
+        }
+
+        return table;
+    }
+
+
+    constexpr Table GenerateRookMoves() {
+
+        Table table {};
+
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+            table[squareIdx] = GenerateRay(squareIdx, 0, -1) | GenerateRay(squareIdx, 0, 1) |
+                               GenerateRay(squareIdx, -1, 0) | GenerateRay(squareIdx, 1, 0);
+        }
+
+        return table;
+    }
+
+
+    constexpr Table GenerateQueenMoves() {
+
+        Table table {};
+        Table bishopMoves = GenerateBishopMoves();
+        Table rookMoves = GenerateRookMoves();
+
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++)
+            table[squareIdx] = bishopMoves[squareIdx] | rookMoves[squareIdx];
+
+        return table;
+    }
+
+
+    // Squares a pawn attacks diagonally, for every square including the back ranks
+    constexpr Table GeneratePawnAttacks(int rowStep) {
+
+        Table table {};
+
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+            int row = squareIdx / 8 + rowStep;
+            int file = squareIdx % 8;
+
+            if (row < 0 || row > 7)
+                continue;
+            if (file > 0)
+                SetBit(table[squareIdx], file - 1 + row * 8);
+            if (file < 7)
+                SetBit(table[squareIdx], file + 1 + row * 8);
+        }
+
+        return table;
+    }
+
+
+    using SquarePairTable = std::array<Table, 64>;
+
+    // betweenTable[a][b] holds the squares strictly between a and b, and lineTable[a][b]
+    // the whole edge-to-edge line through both. Both are empty if a and b are not aligned
+    constexpr SquarePairTable GenerateSquarePairTable(bool isLine) {
+
+        SquarePairTable table {};
+        constexpr int steps[8][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0},
+                                     {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+
+        for (int from = 0; from < 64; from++) {
+            for (auto &step : steps) {
+
+                uint64_t between = EMPTY_BITBOARD;
+                int file = from % 8 + step[0];
+                int row = from / 8 + step[1];
+
+                while (file >= 0 && file < 8 && row >= 0 && row < 8) {
+
+                    int to = file + row * 8;
+
+                    if (isLine)
+                        table[from][to] = GenerateRay(from, step[0], step[1]) | GenerateRay(from, -step[0], -step[1]) | (1ULL << from);
+                    else
+                        table[from][to] = between;
+
+                    SetBit(between, to);
+                    file += step[0];
+                    row += step[1];
+                }
+            }
+        }
+
+        return table;
+    }
+
+
+    /* LOOKUP TABLES */
+    // Each table is 512 bytes, i.e. eight cache lines, and starts on a line boundary
+    alignas(64) inline constexpr Table whitePawnLookupTable = GenerateWhitePawnMoves();
+    alignas(64) inline constexpr Table blackPawnLookupTable = GenerateBlackPawnMoves();
+    alignas(64) inline constexpr Table knightLookupTable = GenerateKnightMoves();
+    alignas(64) inline constexpr Table bishopLookupTable = GenerateBishopMoves();
+    alignas(64) inline constexpr Table rookLookupTable = GenerateRookMoves();
+    alignas(64) inline constexpr Table queenLookupTable = GenerateQueenMoves();
+    alignas(64) inline constexpr Table kingLookupTable = GenerateKingMoves();
+
+    // Capture-only pawn tables, used to find pawns attacking a square
+    alignas(64) inline constexpr Table whitePawnAttackTable = GeneratePawnAttacks(-1);
+    alignas(64) inline constexpr Table blackPawnAttackTable = GeneratePawnAttacks(1);
+
+    alignas(64) inline constexpr SquarePairTable betweenTable = GenerateSquarePairTable(false);
+    alignas(64) inline constexpr SquarePairTable lineTable = GenerateSquarePairTable(true);
+
+    // Spot checks, so a broken generator fails the build rather than the game
+    static_assert(knightLookupTable[0] == ((1ULL << 10) | (1ULL << 17)), "knight on a8");
+    static_assert(kingLookupTable[60] == ((7ULL << 51) | (1ULL << 59) | (1ULL << 61)), "king on e1");
+    static_assert(whitePawnLookupTable[52] == ((1ULL << 44) | (1ULL << 36) | (1ULL << 43) | (1ULL << 45)), "white pawn on e2");
+    static_assert(rookLookupTable[0] == ((AFile | Rank8) & ~1ULL), "rook on a8");
+    static_assert(betweenTable[0][63] == (bishopLookupTable[0] & ~(1ULL << 63)), "a8 to h1");
+    static_assert(lineTable[9][18] == (bishopLookupTable[0] | 1ULL), "b7 to c6");
+    static_assert(betweenTable[0][17] == EMPTY_BITBOARD, "a8 to b6");
+}
@@ -0,0 +1,106 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0) {
+
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    fileDescriptor = -1;
+#endif
+}
+
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+
+bool MappedFile::Open(const std::string &path) {
+
+    Close();
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        Close();
+        return false;
+    }
+
+    if (fileSize.QuadPart > 0) {
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data = mappingHandle ? static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (!data) {
+            Close();
+            return false;
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+    }
+#else
+    fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+        return false;
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+        Close();
+        return false;
+    }
+
+    if (fileStatus.st_size > 0) {
+        void *mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping == MAP_FAILED) {
+            Close();
+            return false;
+        }
+
+        // Readers usually go through the whole file, often from several threads at once
+        madvise(mapping, fileStatus.st_size, MADV_WILLNEED);
+        data = static_cast<const char *>(mapping);
+        size = static_cast<size_t>(fileStatus.st_size);
+    }
+#endif
+
+    return true;
+}
+
+
+void MappedFile::Close() {
+
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    if (data)
+        munmap(const_cast<char *>(data), size);
+    if (fileDescriptor >= 0)
+        close(fileDescriptor);
+
+    fileDescriptor = -1;
+#endif
+
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// A whole file mapped read-only into memory, using mmap on POSIX and a file mapping on Windows.
+// The data stays valid until Close() or destruction
+class MappedFile {
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        // Maps the file at path, closing any file mapped before. Returns false if it cannot be
+        // opened or mapped. An empty file cannot be mapped, but opens with no data and size 0
+        bool Open(const std::string &path);
+
+        void Close();
+
+        const char *GetData() const {return data;}
+        size_t GetSize() const {return size;}
+
+    private:
+        const char *data;
+        size_t size;
+
+        // Handles of the open file and its mapping, which differ between Windows and POSIX
+#ifdef _WIN32
+        void *fileHandle;
+        void *mappingHandle;
+#else
+        int fileDescriptor;
+#endif
+};
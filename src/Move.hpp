@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+// A move packed into 16 bits:
+//   bits 0-5    from square
+//   bits 6-11   to square
+//   bits 12-15  0 normal, 1 double push, 2 castling, 3 en passant,
+//               4-7 promotion to rook, knight, bishop or queen (PieceType - 1)
+class Move {
+
+    public:
+        enum Flag {NORMAL, DOUBLE_PUSH, CASTLING, EN_PASSANT, PROMOTION};
+
+        // Left uninitialised, so a MoveList's array costs nothing to create
+        Move() = default;
+
+        // promotion is a PieceType from ROOK to QUEEN, and is only read with the PROMOTION flag
+        constexpr Move(int from, int to, int flag = NORMAL, int promotion = 0) :
+            data(static_cast<uint16_t>(from | (to << 6) | ((flag == PROMOTION ? 4 + promotion - 1 : flag) << 12))) {}
+
+        int GetFrom() const {return data & 0x3F;}
+        int GetTo() const {return (data >> 6) & 0x3F;}
+        int GetFlag() const {return (data >> 12) >= 4 ? PROMOTION : (data >> 12);}
+
+        // The PieceType promoted to
+        int GetPromotion() const {return ((data >> 12) & 3) + 1;}
+
+        // The raw 16 bits, for storing moves in tables. Data 0 (a8 to a8) is never a real move
+        uint16_t GetData() const {return data;}
+        static Move FromData(uint16_t data) {Move move; move.data = data; return move;}
+        static Move None() {return FromData(0);}
+        bool IsNone() const {return data == 0;}
+
+        bool operator==(const Move &other) const {return data == other.data;}
+        bool operator!=(const Move &other) const {return data != other.data;}
+
+        // Long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q"
+        std::string ToString() const {
+
+            std::string text = {static_cast<char>('a' + GetFrom() % 8), static_cast<char>('8' - GetFrom() / 8),
+                                static_cast<char>('a' + GetTo() % 8), static_cast<char>('8' - GetTo() / 8)};
+
+            // Indexed by PieceType
+            if (GetFlag() == PROMOTION)
+                text += "prnbqk"[GetPromotion()];
+
+            return text;
+        }
+
+    private:
+        uint16_t data;
+};
+
+static_assert(sizeof(Move) == 2, "Move must stay packed into 16 bits");
+
+
+// The moves generated for one position, held in a fixed array on the stack. No legal chess
+// position has more than 218 moves, so 256 holds every board that passes ValidateBoard's
+// material limits in Position.cpp. Add asserts the bound, so a gap in those limits fails loudly
+class MoveList {
+
+    public:
+        static constexpr int MAX_MOVES = 256;
+
+        MoveList() : count(0) {}
+
+        void Add(Move move) {
+            assert(count < MAX_MOVES);
+            moves[count++] = move;
+        }
+
+        void Add(int from, int to, int flag = Move::NORMAL, int promotion = 0) {Add(Move(from, to, flag, promotion));}
+
+        void Clear() {count = 0;}
+
+        size_t size() const {return count;}
+        Move &operator[](size_t idx) {return moves[idx];}
+        const Move &operator[](size_t idx) const {return moves[idx];}
+
+        Move *begin() {return moves.data();}
+        Move *end() {return moves.data() + count;}
+        const Move *begin() const {return moves.data();}
+        const Move *end() const {return moves.data() + count;}
+
+    private:
+        std::array<Move, MAX_MOVES> moves;
+        int count;
+};
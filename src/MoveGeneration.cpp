@@ -1,415 +1,311 @@
 #include "MoveGeneration.hpp"
 
-MoveGeneration::MoveGeneration() {
-
-    GenerateWhitePawnMoves();
-    GenerateBlackPawnMoves();
-    GenerateKnightMoves();
-    GenerateBishopMoves();
-    GenerateRookMoves();
-    GenerateQueenMoves();
-    GenerateKingMoves();
+// Shifts every bit of bitboard by offset squares, towards h1 if offset is positive
+static inline uint64_t Shift(uint64_t bitboard, int offset) {
+    return (offset > 0) ? (bitboard << offset) : (bitboard >> -offset);
 }
 
 
-uint64_t MoveGeneration::FilterPawnMoves(int firstClickIdx, uint64_t generatedMoves, char colour, uint64_t opponentBitboard) {
+// Adds one pawn move per bit of targets, each coming from offset squares behind it. A pinned
+// pawn may only move along its pin line. Promotions are expanded into the four pieces
+static void AddPawnMoves(MoveList &moveList, uint64_t targets, int offset, int flag,
+                         uint64_t pinned, int kingIdx)
+{
+    while (targets) {
 
-    if (colour == 'w') {
-        if ((opponentBitboard & (1ULL << (firstClickIdx + UP_LEFT))) == 0) 
-            generatedMoves &= ~(1ULL << (firstClickIdx + UP_LEFT));        
-        if ((opponentBitboard & (1ULL << (firstClickIdx + UP_RIGHT ))) == 0) 
-            generatedMoves &= ~(1ULL << (firstClickIdx + UP_RIGHT)); 
+        int to = Bitboard::PopLsb(targets);
+        int from = to - offset;
 
-        // Block the pawn if there is a piece in front of it 
-        if ((opponentBitboard & (1ULL << (firstClickIdx + UP)))) {
-            generatedMoves &= ~(1ULL << (firstClickIdx + 2 * UP));
-            generatedMoves &= ~(1ULL << (firstClickIdx + UP));
-        }
-        if ((opponentBitboard & (1ULL << (firstClickIdx + 2 * UP))))
-            generatedMoves &= ~(1ULL << (firstClickIdx + UP));
-    }
+        if ((pinned & (1ULL << from)) && !(LookupTables::lineTable[kingIdx][from] & (1ULL << to)))
+            continue;
 
-    else {
-        if ((opponentBitboard & (1ULL << (firstClickIdx + DOWN_RIGHT))) == 0) 
-            generatedMoves &= ~(1ULL << (firstClickIdx + DOWN_RIGHT));        
-        if ((opponentBitboard & (1ULL << (firstClickIdx + DOWN_LEFT))) == 0) 
-            generatedMoves &= ~(1ULL << (firstClickIdx + DOWN_LEFT)); 
-                   
-        // Block the pawn if there is a piece in front of it 
-        if ((opponentBitboard & (1ULL << (firstClickIdx + DOWN)))) {
-            generatedMoves &= ~(1ULL << (firstClickIdx + 2 * DOWN));
-            generatedMoves &= ~(1ULL << (firstClickIdx + DOWN));
+        if (flag == Move::PROMOTION) {
+            moveList.Add(from, to, Move::PROMOTION, QUEEN);
+            moveList.Add(from, to, Move::PROMOTION, ROOK);
+            moveList.Add(from, to, Move::PROMOTION, BISHOP);
+            moveList.Add(from, to, Move::PROMOTION, KNIGHT);
         }
-        if ((opponentBitboard & (1ULL << (firstClickIdx + 2 * DOWN))))
-            generatedMoves &= ~(1ULL << (firstClickIdx + DOWN));
-    }
 
-    return generatedMoves;
+        else
+            moveList.Add(from, to, flag);
+    }
 }
 
 
-inline bool MoveGeneration::CheckIsOccupied(int targetSquareIdx, uint64_t allPieceBitboard) {
+// The king's and rook's squares for each castling move. The squares between king and rook
+// must be empty, but only those the king crosses or lands on must be safe
+struct CastlingMove {int right, kingFrom, kingTo, rookFrom; uint64_t emptySquares, safeSquares;};
+static constexpr CastlingMove castlingMoves[4] = {
+    {WHITE_KINGSIDE, 60, 62, 63, (1ULL << 61) | (1ULL << 62), (1ULL << 61) | (1ULL << 62)},
+    {WHITE_QUEENSIDE, 60, 58, 56, (1ULL << 57) | (1ULL << 58) | (1ULL << 59), (1ULL << 58) | (1ULL << 59)},
+    {BLACK_KINGSIDE, 4, 6, 7, (1ULL << 5) | (1ULL << 6), (1ULL << 5) | (1ULL << 6)},
+    {BLACK_QUEENSIDE, 4, 2, 0, (1ULL << 1) | (1ULL << 2) | (1ULL << 3), (1ULL << 2) | (1ULL << 3)}
+};
 
-    if ((allPieceBitboard & (1ULL << (targetSquareIdx))) == EMPTY_BITBOARD) 
-        return false;
-    else 
-        return true;
-}
 
+// Whether the side to move may castle, given it is not in check
+static bool CanCastle(const Position &position, const CastlingMove &castle, uint64_t kingDanger) {
 
-inline bool MoveGeneration::CheckIsOccupiedByOwn(int targetSquareIdx, uint64_t ownBitboard)
-{
-        if ((ownBitboard & (1ULL << (targetSquareIdx))) == EMPTY_BITBOARD) 
-            return false;
-        else
-            return true;
-}
+    Colour us = position.GetActiveColour();
 
-
-inline bool MoveGeneration::CheckIsOccupiedByOpponent(int targetSquareIdx, uint64_t opponentBitboard)
-{
-        if ((opponentBitboard & (1ULL << (targetSquareIdx))) == EMPTY_BITBOARD) 
-            return false;
-        else
-            return true;
+    return (position.GetCastlingRights() & castle.right) && position.GetKingSquare(us) == castle.kingFrom &&
+           (position.GetPieces(us, ROOK) & (1ULL << castle.rookFrom)) &&
+           !(position.GetAllPieces() & castle.emptySquares) && !(kingDanger & castle.safeSquares);
 }
 
-inline void MoveGeneration::SetBit(uint64_t &bitBoard, int idx) {
-    bitBoard |= (1ULL << idx);
-}
 
+template <MoveGeneration::GenType type>
+void MoveGeneration::Generate(const Position &position, MoveList &moveList) {
 
-bool MoveGeneration::CheckCanMakeMove(int secondClickIdx, uint64_t possibleMoves) {
+    using namespace LookupTables;
+    using Bitboard::PopLsb;
 
-    if ((possibleMoves & (1ULL << secondClickIdx)) != EMPTY_BITBOARD)
-        return true;
-    else
-        return false;
-}
+    Colour us = position.GetActiveColour();
+    Colour them = (us == WHITE) ? BLACK : WHITE;
 
+    uint64_t ownPieces = position.GetColourPieces(us);
+    uint64_t opponentPieces = position.GetColourPieces(them);
+    uint64_t occupancy = position.GetAllPieces();
+    int kingIdx = position.GetKingSquare(us);
 
-void MoveGeneration::GenerateWhitePawnMoves() {
+    uint64_t checkers = position.GetAttackersTo(kingIdx) & opponentPieces;
 
-    // White pawns move UP, UP_LEFT, UP_RIGHT, 2 * UP_RIGHT
+    // The destinations each kind of generation is restricted to
+    uint64_t typeMask = (type == CAPTURES) ? opponentPieces : (type == QUIETS) ? ~occupancy : ~ownPieces;
 
-    // This range used because rank 8 pawns get promoted, and pawns start on rank 2
-    for (int squareIdx = 8; squareIdx < 56; squareIdx++) {
+    // King moves, to any square the opponent does not attack even once the king has left its square
+    uint64_t kingDanger = position.GetKingDangerSquares();
+    uint64_t kingTargets = kingLookupTable[kingIdx] & typeMask & ~kingDanger;
 
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD;
+    while (kingTargets)
+        moveList.Add(kingIdx, PopLsb(kingTargets));
 
-        SetBit(currentBitboard, squareIdx);
+    // In double check only the king can move
+    if (Bitboard::HasMoreThanOne(checkers))
+        return;
 
-        bool isAFile = (currentBitboard & AFile);
-        bool isHFile = (currentBitboard & HFile);
+    // Any other move must capture the checking piece or block it, if there is one
+    uint64_t evasionMask = checkers ? (betweenTable[kingIdx][Bitboard::GetLsbIdx(checkers)] | checkers) : ~EMPTY_BITBOARD;
 
-        // Normal pawns (not rank 2)
-        if (squareIdx < 48) {
-            SetBit(moveBitboard, squareIdx + UP);
-            if (!isAFile) 
-                SetBit(moveBitboard, squareIdx + UP_LEFT);
-            if (!isHFile)
-                SetBit(moveBitboard, squareIdx + UP_RIGHT);
-        }
+    // A piece is pinned if it is the only piece between the king and an opponent slider on the same line.
+    // It may then only move along that line, given by lineTable[kingIdx][pinned square]
+    uint64_t opponentQueens = position.GetPieces(them, QUEEN);
+    uint64_t snipers = (rookLookupTable[kingIdx] & (position.GetPieces(them, ROOK) | opponentQueens))
+                     | (bishopLookupTable[kingIdx] & (position.GetPieces(them, BISHOP) | opponentQueens));
+    uint64_t pinned = EMPTY_BITBOARD;
 
-        // Rank 2 pawns
-        else {
-            SetBit(moveBitboard, squareIdx + UP);
-            SetBit(moveBitboard, squareIdx + 2 * UP);
-            if (!isAFile) 
-                SetBit(moveBitboard, squareIdx + UP_LEFT);
-            if (!isHFile)
-                SetBit(moveBitboard, squareIdx + UP_RIGHT);
-        }
-
-        whitePawnLookupTable[squareIdx] = moveBitboard;
+    while (snipers) {
+        uint64_t blockers = betweenTable[kingIdx][PopLsb(snipers)] & occupancy;
+        if (blockers && !Bitboard::HasMoreThanOne(blockers) && (blockers & ownPieces))
+            pinned |= blockers;
     }
-}
 
+    uint64_t targetMask = typeMask & evasionMask;
 
-void MoveGeneration::GenerateBlackPawnMoves() {
-
-    // Black pawns move: 2 * DOWN, DOWN, DOWN_LEFT, DOWN_RIGHT
-
-    // This range used because bottom rank can't move, and pawns start on rank 7
-    for (int squareIdx = 8; squareIdx < 56; squareIdx++) {
-        
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD;
+    // Knights can never move along a pin line
+    uint64_t knights = position.GetPieces(us, KNIGHT) & ~pinned;
+    while (knights) {
+        int from = PopLsb(knights);
+        uint64_t targets = knightLookupTable[from] & targetMask;
+        while (targets)
+            moveList.Add(from, PopLsb(targets));
+    }
 
-        SetBit(currentBitboard, squareIdx);
+    uint64_t queens = position.GetPieces(us, QUEEN);
+    uint64_t sliders[2] = {position.GetPieces(us, BISHOP) | queens, position.GetPieces(us, ROOK) | queens};
 
-        bool isAFile = (currentBitboard & AFile);
-        bool isHFile = (currentBitboard & HFile);
+    for (int isRook = 0; isRook < 2; isRook++) {
+        while (sliders[isRook]) {
+            int from = PopLsb(sliders[isRook]);
+            uint64_t targets = (isRook ? GetRookMoves(from, occupancy) : GetBishopMoves(from, occupancy)) & targetMask;
 
-        // Normal pawns (not rank 7)
-        if (squareIdx > 15) {
-            SetBit(moveBitboard, squareIdx + DOWN);
-            if (!isAFile) 
-                SetBit(moveBitboard, squareIdx + DOWN_LEFT);
-            if (!isHFile)
-                SetBit(moveBitboard, squareIdx + DOWN_RIGHT);  
-        }
+            if (pinned & (1ULL << from))
+                targets &= lineTable[kingIdx][from];
 
-        // Rank 7 pawns
-        else {
-            SetBit(moveBitboard, squareIdx + DOWN);
-            SetBit(moveBitboard, squareIdx + 2 * DOWN);
-            if (!isAFile) 
-                SetBit(moveBitboard, squareIdx + DOWN_LEFT);
-            if (!isHFile)
-                SetBit(moveBitboard, squareIdx + DOWN_RIGHT);
+            while (targets)
+                moveList.Add(from, PopLsb(targets));
         }
-
-        blackPawnLookupTable[squareIdx] = moveBitboard;
     }
-}
-
 
-void MoveGeneration::GenerateKnightMoves() {
+    // Pawns are generated for the whole side at once by shifting the pawn bitboard
+    uint64_t pawns = position.GetPieces(us, PAWN);
+    uint64_t emptySquares = ~occupancy;
+    uint64_t promotionRank = (us == WHITE) ? Rank8 : Rank1;
 
-    uint64_t ABFile = AFile | BFile;
-    uint64_t GHFile = GFile | HFile;
-    uint64_t Rank12 = Rank1 | Rank2;
-    uint64_t Rank78 = Rank7 | Rank8;
+    // Towards the a and h files respectively; the source file mask stops captures wrapping around the board
+    int forward = (us == WHITE) ? UP : DOWN;
+    int captureLeft = (us == WHITE) ? UP_LEFT : DOWN_LEFT;
+    int captureRight = (us == WHITE) ? UP_RIGHT : DOWN_RIGHT;
 
-    std::array<int, 8> knightMoves = {-17, -15, -10, -6, 6, 10, 15, 17};
+    // A double push is a second single push from the rank just in front of the starting rank
+    uint64_t singlePushes = Shift(pawns, forward) & emptySquares;
+    uint64_t doublePushes = Shift(singlePushes & ((us == WHITE) ? Rank3 : Rank6), forward) & emptySquares & evasionMask;
+    singlePushes &= evasionMask;
 
-    for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+    uint64_t leftCaptures = Shift(pawns & ~AFile, captureLeft) & opponentPieces & evasionMask;
+    uint64_t rightCaptures = Shift(pawns & ~HFile, captureRight) & opponentPieces & evasionMask;
 
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD; 
+    // Promotions count as captures, so that quiescence search sees them
+    if (type != CAPTURES) {
+        AddPawnMoves(moveList, singlePushes & ~promotionRank, forward, Move::NORMAL, pinned, kingIdx);
+        AddPawnMoves(moveList, doublePushes, 2 * forward, Move::DOUBLE_PUSH, pinned, kingIdx);
+    }
 
-        SetBit(currentBitboard, squareIdx);
+    if (type != QUIETS) {
+        AddPawnMoves(moveList, leftCaptures & ~promotionRank, captureLeft, Move::NORMAL, pinned, kingIdx);
+        AddPawnMoves(moveList, rightCaptures & ~promotionRank, captureRight, Move::NORMAL, pinned, kingIdx);
 
-        // Knights on the middle squares can use any move
-        if ((currentBitboard & (OuterEdge | InnerEdge)) == EMPTY_BITBOARD) {
-            for (auto &move : knightMoves) {
-                SetBit(moveBitboard, squareIdx + move);
-            }
+        if ((singlePushes | leftCaptures | rightCaptures) & promotionRank) {
+            AddPawnMoves(moveList, singlePushes & promotionRank, forward, Move::PROMOTION, pinned, kingIdx);
+            AddPawnMoves(moveList, leftCaptures & promotionRank, captureLeft, Move::PROMOTION, pinned, kingIdx);
+            AddPawnMoves(moveList, rightCaptures & promotionRank, captureRight, Move::PROMOTION, pinned, kingIdx);
         }
+    }
 
-        // Consider other squares
-        else {
-            for (auto &move : knightMoves) {
-
-                // Move has to stay on the board
-                if (move + squareIdx < 64 && move + squareIdx > -1) {
-
-                    // Consider the posibility for specific moves 
-                    if (move == -17 && (currentBitboard & (AFile | Rank78)) == EMPTY_BITBOARD) 
-                        SetBit(moveBitboard, squareIdx + move);
-                    
-                    else if (move == -15 && (currentBitboard & (HFile | Rank78)) == EMPTY_BITBOARD) 
-                        SetBit(moveBitboard, squareIdx + move);
-
-                    else if (move == -10 && (currentBitboard & (ABFile | Rank8)) == EMPTY_BITBOARD) 
-                        SetBit(moveBitboard, squareIdx + move);
-    
-                    else if (move == -6 && (currentBitboard & (GHFile | Rank8)) == EMPTY_BITBOARD) 
-                        SetBit(moveBitboard, squareIdx + move);
-
-                    else if (move == 6 && (currentBitboard & (ABFile | Rank1)) == EMPTY_BITBOARD) 
-                        SetBit(moveBitboard, squareIdx + move);
+    // En passant removes two pawns from one rank, which no pin or evasion mask describes,
+    // so each capturer is checked by looking for attacks on the king in the resulting occupancy
+    int enPassantIdx = position.GetEnPassantSquare();
 
-                    else if (move == 10 && (currentBitboard & (GHFile | Rank1)) == EMPTY_BITBOARD)
-                        SetBit(moveBitboard, squareIdx + move);
+    if (type != QUIETS && enPassantIdx != NO_SQUARE) {
 
-                    else if (move == 15 && (currentBitboard & (AFile | Rank12)) == EMPTY_BITBOARD) 
-                        SetBit(moveBitboard, squareIdx + move);
+        // Our pawns attacking the square are those an opponent pawn there would attack
+        uint64_t capturers = ((us == WHITE) ? blackPawnAttackTable : whitePawnAttackTable)[enPassantIdx] & pawns;
+        uint64_t capturedPawn = 1ULL << (enPassantIdx - forward);
 
-                    else if (move == 17 && (currentBitboard & (HFile | Rank12)) == EMPTY_BITBOARD)
-                        SetBit(moveBitboard, squareIdx + move);
-                }
-            }
-        }       
+        while (capturers) {
+            int from = PopLsb(capturers);
+            uint64_t occupancyAfter = (occupancy ^ (1ULL << from) ^ capturedPawn) | (1ULL << enPassantIdx);
 
-        // Add possible moves from a certain square to the lookup table   
-        knightLookupTable[squareIdx] = moveBitboard;
+            if (!(position.GetAttackersTo(kingIdx, occupancyAfter) & opponentPieces & ~capturedPawn))
+                moveList.Add(from, enPassantIdx, Move::EN_PASSANT);
+        }
     }
-}
-
-void MoveGeneration::GenerateKingMoves() {
-
-    std::array<int, 8> kingMoves = {UP, DOWN, LEFT, RIGHT, UP_LEFT, UP_RIGHT, DOWN_LEFT, DOWN_RIGHT};
-
-    for (int squareIdx  = 0; squareIdx < 64; squareIdx++) {
-        
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD; 
 
-        SetBit(currentBitboard, squareIdx);
-        
-        // Kings not on the outer edge of the board can move anywhere
-        if ((currentBitboard & OuterEdge) == EMPTY_BITBOARD) {
-            for (auto &move : kingMoves)
-                SetBit(moveBitboard, squareIdx + move);  
-        }
+    // Castling is a quiet move, and never an answer to check
+    if (type == CAPTURES || type == EVASIONS || checkers)
+        return;
 
-        else {
-            for (auto &move : kingMoves) {
-
-                // Checks for pieces leaving the board vertically
-                if (squareIdx + move > -1 && squareIdx + move < 64) {
-
-                    if (move == UP || move == DOWN)
-                        SetBit(moveBitboard, squareIdx + move);
-                    
-                    // Check for pieces wrapping around the board left
-                    else if ((move == LEFT || move == DOWN_LEFT || move == UP_LEFT) && 
-                        (currentBitboard & AFile) == EMPTY_BITBOARD)
-                    {
-                        SetBit(moveBitboard, squareIdx + move);
-                    }
-
-                    // And right
-                    else if ((move == RIGHT || move == DOWN_RIGHT || move == DOWN_LEFT) && 
-                             (currentBitboard & HFile) == EMPTY_BITBOARD)
-                    {
-                        SetBit(moveBitboard, squareIdx + move);
-                    }
-                } 
-            }
-        }
+    for (int i = (us == WHITE) ? 0 : 2; i < ((us == WHITE) ? 2 : 4); i++) {
 
-        kingLookupTable[squareIdx] = moveBitboard;
+        if (CanCastle(position, castlingMoves[i], kingDanger))
+            moveList.Add(castlingMoves[i].kingFrom, castlingMoves[i].kingTo, Move::CASTLING);
     }
 }
 
-void MoveGeneration::GenerateBishopMoves() {
-
-    std::array<int, 4> bishopMoves = {UP_LEFT, UP_RIGHT, DOWN_LEFT, DOWN_RIGHT};
 
-    for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
-
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD;
-        
-        SetBit(currentBitboard, squareIdx);
+void MoveGeneration::GenerateLegalMoves(const Position &position, MoveList &moveList) {
+    Generate<ALL>(position, moveList);
+}
 
-        for (auto &move : bishopMoves) {
 
-            // See where the move would land
-            int currentSquare =  squareIdx;
-            int nextSquare = currentSquare + move;
+void MoveGeneration::GenerateCaptures(const Position &position, MoveList &moveList) {
+    Generate<CAPTURES>(position, moveList);
+}
 
-            bool leftMove = (move == UP_LEFT || move == DOWN_LEFT);
-            bool rightMove = (move == UP_RIGHT || move == DOWN_RIGHT);
 
-            // See if the current square is on the edge of the board
-            bool isAFile = (EMPTY_BITBOARD | (1ULL << currentSquare)) & AFile;
-            bool isHFile = (EMPTY_BITBOARD | (1ULL << currentSquare)) & HFile;
+void MoveGeneration::GenerateQuiets(const Position &position, MoveList &moveList) {
+    Generate<QUIETS>(position, moveList);
+}
 
-            while (nextSquare > -1 && nextSquare < 64) {
 
-                if ((leftMove && isAFile) || (rightMove && isHFile))
-                    break;
+void MoveGeneration::GenerateEvasions(const Position &position, MoveList &moveList) {
+    Generate<EVASIONS>(position, moveList);
+}
 
-                SetBit(moveBitboard, nextSquare);
-                currentSquare += move;
-                nextSquare += move;
 
-                isAFile = (EMPTY_BITBOARD | (1ULL << (currentSquare))) & AFile;
-                isHFile = (EMPTY_BITBOARD | (1ULL << (currentSquare))) & HFile;
-            }
-        }
+bool MoveGeneration::IsCapture(const Position &position, Move move) {
 
-        bishopLookupTable[squareIdx] = moveBitboard;
-    }
+    return move.GetFlag() == Move::EN_PASSANT || move.GetFlag() == Move::PROMOTION ||
+           (position.GetAllPieces() & (1ULL << move.GetTo()));
 }
 
 
-void MoveGeneration::GenerateRookMoves() {
+bool MoveGeneration::IsLegal(const Position &position, Move move) {
 
-    std::array<int, 4> rookMoves = {UP, DOWN, LEFT, RIGHT};
+    using namespace LookupTables;
 
-    for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
-
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD;
-        
-        SetBit(currentBitboard, squareIdx);
-
-        for (auto &move : rookMoves) {
+    // Flag values 8 to 15 are unused, but would otherwise read back as promotions
+    if (move.IsNone() || move != Move(move.GetFrom(), move.GetTo(), move.GetFlag(), move.GetPromotion()))
+        return false;
 
-            // See where the move would land
-            int currentSquare = squareIdx;
-            int nextSquare = currentSquare + move;
+    Colour us = position.GetActiveColour();
+    Colour them = (us == WHITE) ? BLACK : WHITE;
 
-            // See if the current square is on the edge
-            bool isAFile = (EMPTY_BITBOARD | (1ULL << currentSquare)) & AFile;
-            bool isHFile = (EMPTY_BITBOARD | (1ULL << currentSquare)) & HFile;
+    int from = move.GetFrom();
+    int to = move.GetTo();
+    int flag = move.GetFlag();
+    uint64_t toBit = 1ULL << to;
+    uint64_t ownPieces = position.GetColourPieces(us);
+    uint64_t opponentPieces = position.GetColourPieces(them);
+    uint64_t occupancy = position.GetAllPieces();
+    int kingIdx = position.GetKingSquare(us);
 
-            while (nextSquare > -1 && nextSquare < 64) {
+    int piece = position.GetPieceOn(from);
+    if (piece == NO_PIECE || !(ownPieces & (1ULL << from)) || (ownPieces & toBit))
+        return false;
 
-                if ((move == LEFT && isAFile) || (move == RIGHT && isHFile))
-                    break;
+    int pieceType = piece % 6;
 
-                SetBit(moveBitboard, nextSquare);
-                currentSquare += move;
-                nextSquare += move;
+    if (flag == Move::CASTLING) {
+        if (pieceType != KING || (position.GetAttackersTo(kingIdx) & opponentPieces))
+            return false;
 
-                isAFile = (EMPTY_BITBOARD | (1ULL << (currentSquare))) & AFile;
-                isHFile = (EMPTY_BITBOARD | (1ULL << (currentSquare))) & HFile;
-            }
+        for (const CastlingMove &castle : castlingMoves) {
+            if (castle.kingFrom == from && castle.kingTo == to)
+                return CanCastle(position, castle, position.GetKingDangerSquares());
         }
 
-        rookLookupTable[squareIdx] = moveBitboard;
+        return false;
     }
-}
-
-void MoveGeneration::GenerateQueenMoves() {
-
-    std::array<int, 8> queenMoves = {UP, DOWN, LEFT, RIGHT, UP_LEFT, UP_RIGHT, DOWN_LEFT, DOWN_RIGHT};
 
-    for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+    // The move has to be one the piece can make from its square
+    uint64_t capturedPawn = EMPTY_BITBOARD;
 
-        uint64_t currentBitboard = EMPTY_BITBOARD;
-        uint64_t moveBitboard = EMPTY_BITBOARD;
-        
-        SetBit(currentBitboard, squareIdx);
+    if (pieceType == PAWN) {
 
-        for (auto &move : queenMoves) {
+        int forward = (us == WHITE) ? UP : DOWN;
+        uint64_t promotionRank = (us == WHITE) ? Rank8 : Rank1;
+        bool isPromotion = (toBit & promotionRank) != EMPTY_BITBOARD;
+        const Table &attackTable = (us == WHITE) ? whitePawnAttackTable : blackPawnAttackTable;
 
-            // See where the move would land
-            int currentSquare =  squareIdx;
-            int nextSquare = currentSquare + move;
-
-            // See if the current square is on the edge
-            bool isAFile = (EMPTY_BITBOARD | (1ULL << currentSquare)) & AFile;
-            bool isHFile = (EMPTY_BITBOARD | (1ULL << currentSquare)) & HFile;
+        if (isPromotion != (flag == Move::PROMOTION))
+            return false;
 
-            bool leftMove = (move == UP_LEFT || move == LEFT || move == DOWN_LEFT);
-            bool rightMove = (move == UP_RIGHT || move == RIGHT || move == DOWN_RIGHT);
+        if (flag == Move::EN_PASSANT) {
+            if (to != position.GetEnPassantSquare() || !(attackTable[from] & toBit))
+                return false;
+            capturedPawn = 1ULL << (to - forward);
+        }
 
-            // Prevent moving off the board vertically
-            while (nextSquare > -1 && nextSquare < 64) {
+        else if (flag == Move::DOUBLE_PUSH) {
+            uint64_t startRank = (us == WHITE) ? Rank2 : Rank7;
+            if (!(startRank & (1ULL << from)) || to != from + 2 * forward || (occupancy & ((1ULL << (from + forward)) | toBit)))
+                return false;
+        }
 
-                if ((leftMove && isAFile) || (rightMove && isHFile))
-                    break;
+        else if (!(to == from + forward && !(occupancy & toBit)) && !(attackTable[from] & opponentPieces & toBit))
+            return false;
+    }
 
-                SetBit(moveBitboard, nextSquare);
+    else {
+        if (flag != Move::NORMAL)
+            return false;
 
-                currentSquare += move;
-                nextSquare += move;
+        uint64_t attacks = (pieceType == KNIGHT) ? knightLookupTable[from]
+                         : (pieceType == BISHOP) ? GetBishopMoves(from, occupancy)
+                         : (pieceType == ROOK) ? GetRookMoves(from, occupancy)
+                         : (pieceType == QUEEN) ? GetQueenMoves(from, occupancy)
+                         : kingLookupTable[from];
 
-                isAFile = (EMPTY_BITBOARD | (1ULL << (currentSquare))) & AFile;
-                isHFile = (EMPTY_BITBOARD | (1ULL << (currentSquare))) & HFile;
-            }
-        }
+        if (!(attacks & toBit))
+            return false;
 
-        queenLookupTable[squareIdx]= moveBitboard;
+        if (pieceType == KING)
+            return !(position.GetKingDangerSquares() & toBit);
     }
-}
 
+    // Any other move is legal if no opponent piece, other than one it captures, attacks the king afterwards
+    uint64_t occupancyAfter = ((occupancy ^ (1ULL << from)) & ~capturedPawn) | toBit;
 
-// Filtering sliding piece moves
-
-    // Need to take into account both of the bitmasks - the occupancy
-    // Reduce the occupancy to the relevant rank and file
-    // "Move" the piece one square in each direction possible
-    // If the square is occupied by an opponent piece
-        // Allow a move to there
-        // Do not allow any moves past there - remove this from the possible directions
-    // If the square is occupied by the player's own piece
-        // Do not allow a move there 
\ No newline at end of file
+    return !(position.GetAttackersTo(kingIdx, occupancyAfter) & opponentPieces & ~toBit & ~capturedPawn);
+}
@@ -0,0 +1,174 @@
+#include <utility>
+#include "MovePicker.hpp"
+#include "Evaluation.hpp"
+#include "StaticExchange.hpp"
+
+// Puts every evasion that takes a piece ahead of every one that does not
+static constexpr int CAPTURE_BONUS = 1 << 20;
+
+
+MovePicker::MovePicker(const Position &position, Move ttMove, Move killer1, Move killer2,
+                       Move counterMove, const ButterflyHistory *history) :
+    position(position), ttMove(ttMove), killers{killer1, killer2}, counterMove(counterMove), history(history), current(0), currentBadCapture(0)
+{
+    stage = position.IsInCheck() ? EVASION_TT : MAIN_TT;
+
+    // Killers are quiet moves only; anything else is left to the stages that generate it.
+    // Evasions are all generated at once, so there is no killer stage to leave them to
+    for (Move &killer : killers) {
+        if (stage == EVASION_TT || killer == ttMove || MoveGeneration::IsCapture(position, killer))
+            killer = Move::None();
+    }
+
+    if (killers[1] == killers[0])
+        killers[1] = Move::None();
+
+    if (stage == EVASION_TT || counterMove == ttMove || counterMove == killers[0] || counterMove == killers[1]
+        || MoveGeneration::IsCapture(position, counterMove))
+        this->counterMove = Move::None();
+}
+
+
+MovePicker::MovePicker(const Position &position, Move ttMove) :
+    position(position), ttMove(ttMove), killers{Move::None(), Move::None()}, counterMove(Move::None()),
+    history(nullptr), current(0), currentBadCapture(0)
+{
+    stage = position.IsInCheck() ? EVASION_TT : QSEARCH_TT;
+
+    if (stage == QSEARCH_TT && !MoveGeneration::IsCapture(position, ttMove))
+        this->ttMove = Move::None();
+}
+
+
+int MovePicker::ScoreCapture(Move move) const {
+
+    int victim = position.GetPieceOn(move.GetTo());
+    int attacker = position.GetPieceOn(move.GetFrom());
+
+    // The same values as the evaluation and StaticExchange, so that the ordering and SEE agree.
+    // The king is worth nothing, and as a taker it is always safe, since only legal moves are generated
+    using Evaluation::pieceValues;
+
+    // Taking en passant lands on an empty square, and a promoting push takes nothing
+    int victimValue = (move.GetFlag() == Move::EN_PASSANT) ? pieceValues[PAWN]
+                    : (victim == NO_PIECE) ? 0 : pieceValues[victim % 6];
+
+    int score = 8 * victimValue - pieceValues[attacker % 6] / 8;
+
+    if (move.GetFlag() == Move::PROMOTION)
+        score += 8 * pieceValues[move.GetPromotion()];
+
+    return score;
+}
+
+
+Move MovePicker::PickBest() {
+
+    while (current < static_cast<int>(moveList.size())) {
+
+        // Selection sort, one step at a time, as most nodes only look at the first few moves
+        int best = current;
+        for (int i = current + 1; i < static_cast<int>(moveList.size()); i++) {
+            if (scores[i] > scores[best])
+                best = i;
+        }
+
+        std::swap(moveList[current], moveList[best]);
+        std::swap(scores[current], scores[best]);
+
+        Move move = moveList[current++];
+        if (!IsAlreadyPicked(move))
+            return move;
+    }
+
+    return Move::None();
+}
+
+
+Move MovePicker::Next() {
+
+    Move move;
+
+    switch (stage) {
+
+        case MAIN_TT:
+        case EVASION_TT:
+        case QSEARCH_TT:
+            stage = static_cast<Stage>(stage + 1);
+            if (MoveGeneration::IsLegal(position, ttMove))
+                return ttMove;
+            return Next();
+
+        case CAPTURE_INIT:
+        case QCAPTURE_INIT:
+            MoveGeneration::GenerateCaptures(position, moveList);
+            for (int i = 0; i < static_cast<int>(moveList.size()); i++)
+                scores[i] = ScoreCapture(moveList[i]);
+            stage = static_cast<Stage>(stage + 1);
+            return Next();
+
+        case CAPTURES:
+            while (!(move = PickBest()).IsNone()) {
+                if (StaticExchange::IsAtLeast(position, move, 0))
+                    return move;
+                badCaptures.Add(move);
+            }
+            stage = KILLER_1;
+            return Next();
+
+        case KILLER_1:
+        case KILLER_2:
+            move = killers[stage - KILLER_1];
+            stage = static_cast<Stage>(stage + 1);
+            if (MoveGeneration::IsLegal(position, move))
+                return move;
+            return Next();
+
+        case COUNTER_MOVE:
+            stage = QUIET_INIT;
+            if (MoveGeneration::IsLegal(position, counterMove))
+                return counterMove;
+            return Next();
+
+        case QUIET_INIT:
+            moveList.Clear();
+            current = 0;
+            MoveGeneration::GenerateQuiets(position, moveList);
+            for (int i = 0; i < static_cast<int>(moveList.size()); i++)
+                scores[i] = ScoreQuiet(moveList[i]);
+            stage = QUIETS;
+            return Next();
+
+        case EVASION_INIT:
+            MoveGeneration::GenerateEvasions(position, moveList);
+            for (int i = 0; i < static_cast<int>(moveList.size()); i++)
+                scores[i] = MoveGeneration::IsCapture(position, moveList[i]) ? CAPTURE_BONUS + ScoreCapture(moveList[i])
+                                                                              : ScoreQuiet(moveList[i]);
+            stage = EVASIONS;
+            return Next();
+
+        case QUIETS:
+            if (!(move = PickBest()).IsNone())
+                return move;
+            stage = BAD_CAPTURES;
+            return Next();
+
+        case BAD_CAPTURES:
+            if (currentBadCapture < static_cast<int>(badCaptures.size()))
+                return badCaptures[currentBadCapture++];
+            stage = DONE;
+            return Move::None();
+
+        case EVASIONS:
+        case QCAPTURES:
+            if (!(move = PickBest()).IsNone())
+                return move;
+            stage = DONE;
+            return Move::None();
+
+        case DONE:
+            return Move::None();
+    }
+
+    return Move::None();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include "Move.hpp"
+#include "MoveGeneration.hpp"
+#include "Position.hpp"
+
+// How well each quiet move, by side to move and from and to square, has done lately: raised when
+// it causes a beta cutoff and lowered when it is searched without one before another move does.
+// Each update pulls the entry towards +/-MAX_HISTORY by the share of the way left ("gravity"),
+// so old results fade and no entry can overflow
+class ButterflyHistory {
+
+    public:
+        static constexpr int MAX_HISTORY = 16384;
+
+        ButterflyHistory() {Clear();}
+
+        void Clear() {table = {};}
+
+        int Get(Colour side, Move move) const {return table[side][move.GetFrom()][move.GetTo()];}
+
+        // bonus is from -MAX_HISTORY to MAX_HISTORY
+        void Update(Colour side, Move move, int bonus) {
+            int16_t &entry = table[side][move.GetFrom()][move.GetTo()];
+            entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+        }
+
+    private:
+        std::array<std::array<std::array<int16_t, 64>, 64>, 2> table;
+};
+
+
+// The quiet move that last refuted each move, indexed by the refuted move's piece and to square
+using CounterMoveTable = std::array<std::array<Move, 64>, 12>;
+
+// Hands out the legal moves of a position one at a time, most promising first, generating each
+// group of moves only once the ones before it have run out. A node that cuts off on the hash
+// move never generates anything. The position must not change while the picker is in use
+class MovePicker {
+
+    public:
+        // For the main search: the hash move, the captures that do not lose material by score, the
+        // killers, the counter move, the quiet moves by history, or as generated without one, and
+        // last the losing captures. ttMove, the killers and the counter move may be Move::None() or
+        // moves from other positions
+        MovePicker(const Position &position, Move ttMove, Move killer1, Move killer2,
+                   Move counterMove = Move::None(), const ButterflyHistory *history = nullptr);
+
+        // For quiescence search: the hash move if it is a capture, then captures only, by score
+        // whether they lose material or not
+        MovePicker(const Position &position, Move ttMove);
+
+        // The next move to try, or Move::None() once every move has been returned
+        Move Next();
+
+    private:
+        // A side in check skips to the evasion stages, whichever constructor was used
+        enum Stage {MAIN_TT, CAPTURE_INIT, CAPTURES, KILLER_1, KILLER_2, COUNTER_MOVE, QUIET_INIT, QUIETS, BAD_CAPTURES,
+                    EVASION_TT, EVASION_INIT, EVASIONS,
+                    QSEARCH_TT, QCAPTURE_INIT, QCAPTURES,
+                    DONE};
+
+        // Orders captures by the value of the piece taken, then by the cheapness of the taker (MVV-LVA)
+        int ScoreCapture(Move move) const;
+
+        // Orders quiet moves by history, if there is one
+        int ScoreQuiet(Move move) const {return history ? history->Get(position.GetActiveColour(), move) : 0;}
+
+        // Removes and returns the best scored move left in moveList, skipping already returned ones
+        Move PickBest();
+
+        // Whether move was handed out by an earlier stage
+        bool IsAlreadyPicked(Move move) const {
+            return move == ttMove || move == killers[0] || move == killers[1] || move == counterMove;
+        }
+
+        const Position &position;
+        Stage stage;
+        Move ttMove;
+        std::array<Move, 2> killers;
+        Move counterMove;
+        const ButterflyHistory *history;
+
+        MoveList moveList;
+        std::array<int, MoveList::MAX_MOVES> scores;
+        int current;
+
+        // Captures that lose material by static exchange evaluation, put off until after the quiet moves
+        MoveList badCaptures;
+        int currentBadCapture;
+};
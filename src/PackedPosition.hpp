@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+// A position in 32 bytes, for storing large numbers of them. Piece codes are the Piece enum
+// values of the occupied squares, taken in square order from a8, two to a byte with the
+// lower-indexed square in the low nibble. A legal position has at most 32 pieces, which is
+// all the record has room for. Multi-byte fields are stored in the machine's byte order,
+// which is little-endian on every platform this builds for
+struct PackedPosition {
+    uint64_t occupancy;
+    std::array<uint8_t, 16> pieces;
+    uint16_t halfMoveClock;
+    uint16_t fullMove;
+
+    // Bit 0 is set with black to move, bits 1-4 hold the CastlingRight flags
+    uint8_t flags;
+
+    // File of the en passant square, or 8 if there is none. The rank follows from the side to move
+    uint8_t enPassantFile;
+
+    // Always zero, so that equal positions have byte-identical records
+    std::array<uint8_t, 2> reserved;
+
+    static constexpr int MAX_PIECES = 32;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+static_assert(std::is_trivially_copyable_v<PackedPosition> && std::is_standard_layout_v<PackedPosition>,
+              "PackedPosition must be readable straight out of a mapped file");
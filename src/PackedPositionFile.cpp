@@ -0,0 +1,53 @@
+#include "PackedPositionFile.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+bool PackedPositionFile::Write(const std::string &path, const PackedPosition *records, uint64_t count) {
+
+    Header header {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(PackedPosition);
+    header.count = count;
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool isWritten = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                     std::fwrite(records, sizeof(PackedPosition), count, file) == count;
+
+    return (std::fclose(file) == 0) && isWritten;
+}
+
+
+bool PackedPositionFile::Open(const std::string &path) {
+
+    records = nullptr;
+    count = 0;
+
+    if (!file.Open(path) || file.GetSize() < sizeof(Header))
+        return false;
+
+    Header header;
+    std::memcpy(&header, file.GetData(), sizeof(header));
+
+    // The file must hold exactly count records, so a truncated last record or trailing bytes
+    // are rejected. A count too large to multiply out cannot match any real file
+    bool isCountTooLarge = header.count > (SIZE_MAX - sizeof(Header)) / sizeof(PackedPosition);
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.recordSize != sizeof(PackedPosition) || isCountTooLarge ||
+        file.GetSize() != sizeof(Header) + header.count * sizeof(PackedPosition))
+    {
+        file.Close();
+        return false;
+    }
+
+    // Mappings start on a page boundary, so the records after the 32-byte header are aligned
+    records = reinterpret_cast<const PackedPosition *>(file.GetData() + sizeof(Header));
+    count = header.count;
+
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "MappedFile.hpp"
+#include "PackedPosition.hpp"
+
+// A file of PackedPosition records: a 32-byte header followed by the records, back to back.
+// Opening maps the file, and the records are used in place without being read or copied
+class PackedPositionFile {
+
+    public:
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t recordSize;
+            uint64_t count;
+            uint64_t reserved;
+        };
+
+        static constexpr char MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'P', 'O', 'S'};
+        static constexpr uint32_t VERSION = 1;
+
+        // Writes count records to path, replacing the file. Returns false on any I/O error
+        static bool Write(const std::string &path, const PackedPosition *records, uint64_t count);
+
+        // Maps the file at path. Returns false if it cannot be mapped, or its header does
+        // not match this version of the format or the size of the file
+        bool Open(const std::string &path);
+
+        uint64_t GetCount() const {return count;}
+        const PackedPosition *GetRecords() const {return records;}
+
+    private:
+        MappedFile file;
+        const PackedPosition *records = nullptr;
+        uint64_t count = 0;
+};
+
+static_assert(sizeof(PackedPositionFile::Header) == sizeof(PackedPosition), "the header keeps records 32-byte aligned");
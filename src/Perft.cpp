@@ -0,0 +1,345 @@
+#include "Perft.hpp"
+#include <algorithm>
+#include <chrono>
+#include "ThreadPool.hpp"
+
+namespace Perft {
+
+    const std::vector<TestPosition> &GetTestPositions() {
+
+        static const std::vector<TestPosition> testPositions = {
+            {"start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                {20, 400, 8902, 197281, 4865609, 119060324}},
+            {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                {48, 2039, 97862, 4085603, 193690690}},
+            {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                {14, 191, 2812, 43238, 674624, 11030083}},
+            {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+                {6, 264, 9467, 422333, 15833292}},
+            {"position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+                {6, 264, 9467, 422333, 15833292}},
+            {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+                {44, 1486, 62379, 2103487, 89941194}},
+            {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+                {46, 2079, 89890, 3894594, 164075551}},
+            {"illegal en passant (rank pin)", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",
+                {0, 0, 0, 0, 0, 1134888}},
+            {"illegal en passant (diagonal pin)", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
+                {0, 0, 0, 0, 0, 1015133}},
+            {"en passant gives check", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+                {0, 0, 0, 0, 0, 1440467}},
+            {"short castling gives check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+                {0, 0, 0, 0, 0, 661072}},
+            {"long castling gives check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",
+                {0, 0, 0, 0, 0, 803711}},
+            {"castling rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",
+                {0, 0, 0, 1274206}},
+            {"castling prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
+                {0, 0, 0, 1720476}},
+            {"promote out of check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
+                {0, 0, 0, 0, 0, 3821001}},
+            {"discovered check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1",
+                {0, 0, 0, 0, 1004658}},
+            {"promote to give check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1",
+                {0, 0, 0, 0, 0, 217342}},
+            {"underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1",
+                {0, 0, 0, 0, 0, 92683}},
+            {"self stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1",
+                {0, 0, 0, 0, 0, 2217}},
+            {"stalemate and checkmate", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1",
+                {0, 0, 0, 0, 0, 0, 567584}},
+            {"double check", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
+                {0, 0, 0, 23527}}
+        };
+
+        return testPositions;
+    }
+
+
+    // Counts the nodes below stack[0], making each child in the next stack entry
+    static uint64_t CountNodesCopyMake(Position *stack, int depth) {
+
+        MoveList moveList;
+        MoveGeneration::GenerateLegalMoves(stack[0], moveList);
+
+        // Bulk counting: every legal move at the last ply is one leaf
+        if (depth == 1)
+            return moveList.size();
+
+        uint64_t nodes = 0;
+
+        for (const Move &move : moveList) {
+            stack[1] = stack[0];
+            stack[1].MakeMove(move);
+            nodes += CountNodesCopyMake(stack + 1, depth - 1);
+        }
+
+        return nodes;
+    }
+
+
+    static uint64_t CountNodesMakeUnmake(Position &position, int depth) {
+
+        MoveList moveList;
+        MoveGeneration::GenerateLegalMoves(position, moveList);
+
+        if (depth == 1)
+            return moveList.size();
+
+        uint64_t nodes = 0;
+
+        for (const Move &move : moveList) {
+            UndoInfo undo = position.MakeMove(move);
+            nodes += CountNodesMakeUnmake(position, depth - 1);
+            position.UnmakeMove(move, undo);
+        }
+
+        return nodes;
+    }
+
+
+    template <UndoStrategy strategy>
+    uint64_t CountNodes(const Position &position, int depth) {
+
+        if (depth == 0)
+            return 1;
+
+        if constexpr (strategy == UndoStrategy::COPY_MAKE) {
+            std::vector<Position> stack(depth, position);
+            return CountNodesCopyMake(stack.data(), depth);
+        }
+
+        else {
+            Position root = position;
+            return CountNodesMakeUnmake(root, depth);
+        }
+    }
+
+    template uint64_t CountNodes<UndoStrategy::COPY_MAKE>(const Position &position, int depth);
+    template uint64_t CountNodes<UndoStrategy::MAKE_UNMAKE>(const Position &position, int depth);
+
+
+    uint64_t CountNodesHashed(const Position &position, int depth, PerftTable &table, PerftTable::Stats &stats) {
+
+        // Bulk counting already makes the last ply cheaper than a table probe
+        if (depth <= 1)
+            return CountNodes(position, depth);
+
+        uint64_t key = position.GetKey();
+        uint64_t nodes = 0;
+
+        stats.probes++;
+        if (table.Probe(key, depth, nodes)) {
+            stats.hits++;
+            return nodes;
+        }
+
+        MoveList moveList;
+        MoveGeneration::GenerateLegalMoves(position, moveList);
+
+        for (const Move &move : moveList) {
+            Position child = position;
+            child.MakeMove(move);
+            nodes += CountNodesHashed(child, depth - 1, table, stats);
+        }
+
+        table.Store(key, depth, nodes);
+        return nodes;
+    }
+
+
+    // Appends every position depth plies below position to positions
+    static void CollectPositions(const Position &position, int depth, std::vector<Position> &positions) {
+
+        if (depth == 0) {
+            positions.push_back(position);
+            return;
+        }
+
+        MoveList moveList;
+        MoveGeneration::GenerateLegalMoves(position, moveList);
+
+        for (const Move &move : moveList) {
+            Position child = position;
+            child.MakeMove(move);
+            CollectPositions(child, depth - 1, positions);
+        }
+    }
+
+
+    uint64_t CountNodesParallel(const Position &position, int depth, int threadCount, int splitDepth,
+                                PerftTable *table, PerftTable::Stats *stats)
+    {
+        PerftTable::Stats localStats;
+        uint64_t nodes = 0;
+
+        if (threadCount <= 1 || splitDepth < 1 || depth <= splitDepth)
+            nodes = table ? CountNodesHashed(position, depth, *table, localStats) : CountNodes(position, depth);
+
+        else {
+            std::vector<Position> subtreeRoots;
+            CollectPositions(position, splitDepth, subtreeRoots);
+
+            // One slot per task, so tasks never contend on a shared counter
+            std::vector<uint64_t> subtreeNodes(subtreeRoots.size(), 0);
+            std::vector<PerftTable::Stats> subtreeStats(subtreeRoots.size());
+            ThreadPool pool(threadCount);
+
+            for (size_t i = 0; i < subtreeRoots.size(); i++) {
+                pool.Submit([&subtreeRoots, &subtreeNodes, &subtreeStats, table, i, depth, splitDepth] {
+                    int subtreeDepth = depth - splitDepth;
+                    subtreeNodes[i] = table ? CountNodesHashed(subtreeRoots[i], subtreeDepth, *table, subtreeStats[i])
+                                            : CountNodes(subtreeRoots[i], subtreeDepth);
+                });
+            }
+
+            pool.Wait();
+
+            for (size_t i = 0; i < subtreeRoots.size(); i++) {
+                nodes += subtreeNodes[i];
+                localStats.probes += subtreeStats[i].probes;
+                localStats.hits += subtreeStats[i].hits;
+            }
+        }
+
+        if (stats) {
+            stats->probes += localStats.probes;
+            stats->hits += localStats.hits;
+        }
+
+        return nodes;
+    }
+
+
+    uint64_t Divide(const Position &position, int depth) {
+
+        MoveList moveList;
+        MoveGeneration::GenerateLegalMoves(position, moveList);
+
+        uint64_t total = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const Move &move : moveList) {
+            Position child = position;
+            child.MakeMove(move);
+
+            uint64_t nodes = (depth > 1) ? CountNodes(child, depth - 1) : 1;
+            std::cout << move.ToString() << ": " << nodes << std::endl;
+            total += nodes;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << std::endl << "Moves: " << moveList.size() << std::endl
+                  << "Nodes: " << total << std::endl
+                  << "Time: " << elapsed.count() << " s" << std::endl;
+
+        return total;
+    }
+
+
+    uint64_t Run(const Position &position, int depth, int threadCount, int splitDepth, int hashMB) {
+
+        std::unique_ptr<PerftTable> table;
+        PerftTable::Stats stats;
+
+        if (hashMB > 0)
+            table = std::make_unique<PerftTable>(hashMB);
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = CountNodesParallel(position, depth, threadCount, splitDepth, table.get(), &stats);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "perft " << depth << ": " << nodes << " nodes in " << elapsed.count() << " s ("
+                  << static_cast<uint64_t>(nodes / std::max(elapsed.count(), 1e-9)) << " nodes/sec, "
+                  << std::max(threadCount, 1) << " threads)" << std::endl;
+
+        if (table) {
+            std::cout << "hash: " << table->GetSizeBytes() / (1024 * 1024) << " MB, " << stats.hits << " hits in "
+                      << stats.probes << " probes (" << 100.0 * stats.hits / std::max<uint64_t>(stats.probes, 1)
+                      << "%)" << std::endl;
+        }
+
+        return nodes;
+    }
+
+
+    bool RunScaling(const Position &position, int depth, int maxThreads, int splitDepth) {
+
+        uint64_t serialNodes = 0;
+        double serialTime = 0.0;
+        bool allMatch = true;
+
+        for (int threadCount = 1; threadCount <= std::max(maxThreads, 1); threadCount *= 2) {
+
+            auto start = std::chrono::steady_clock::now();
+            uint64_t nodes = CountNodesParallel(position, depth, threadCount, splitDepth);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (threadCount == 1) {
+                serialNodes = nodes;
+                serialTime = elapsed;
+            }
+
+            bool matches = (nodes == serialNodes);
+            allMatch = allMatch && matches;
+
+            std::cout << "threads " << threadCount << ": " << nodes << " nodes in " << elapsed << " s, "
+                      << static_cast<uint64_t>(nodes / std::max(elapsed, 1e-9)) << " nodes/sec, speedup "
+                      << serialTime / std::max(elapsed, 1e-9) << "x"
+                      << (matches ? "" : "  MISMATCH with 1 thread") << std::endl;
+        }
+
+        return allMatch;
+    }
+
+
+    bool RunSuite(int maxDepth) {
+
+        bool allPassed = true;
+        uint64_t totalNodes = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const TestPosition &test : GetTestPositions()) {
+
+            Position position;
+            if (!position.SetFromFen(test.fen)) {
+                std::cout << "FAIL " << test.name << ": could not parse FEN" << std::endl;
+                allPassed = false;
+                continue;
+            }
+
+            int depthLimit = std::min<int>(maxDepth, test.nodeCounts.size());
+            bool passed = true;
+
+            for (int depth = 1; depth <= depthLimit; depth++) {
+
+                uint64_t expected = test.nodeCounts[depth - 1];
+                if (expected == 0)
+                    continue;
+
+                uint64_t nodes = CountNodes(position, depth);
+                totalNodes += nodes;
+
+                if (nodes != expected) {
+                    std::cout << "FAIL " << test.name << " depth " << depth << ": "
+                              << nodes << " nodes, expected " << expected << std::endl;
+                    passed = false;
+                }
+            }
+
+            if (passed)
+                std::cout << "ok   " << test.name << " to depth " << depthLimit << std::endl;
+
+            allPassed = allPassed && passed;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << (allPassed ? "All perft counts match" : "Perft counts DO NOT match") << ": "
+                  << totalNodes << " nodes in " << elapsed.count() << " s ("
+                  << static_cast<uint64_t>(totalNodes / std::max(elapsed.count(), 1e-9)) << " nodes/sec)" << std::endl;
+
+        return allPassed;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Position.hpp"
+#include "MoveGeneration.hpp"
+#include "PerftTable.hpp"
+
+// Counts the leaf nodes of the legal move tree, to check move generation and measure its speed
+namespace Perft {
+
+    // A reference position and its known node counts. nodeCounts[d - 1] is the count at depth d, or 0 if not listed
+    struct TestPosition {
+        std::string name;
+        std::string fen;
+        std::vector<uint64_t> nodeCounts;
+    };
+
+    // Standard positions from the Chess Programming Wiki and well-known en passant, castling and
+    // promotion edge cases, whose counts catch most move generation bugs
+    const std::vector<TestPosition> &GetTestPositions();
+
+    // How moves are taken back while walking the tree. COPY_MAKE makes each move on a copy of
+    // the position in a per-ply stack; MAKE_UNMAKE plays and takes back moves on one position
+    // using UndoInfo records. Which is faster depends on the machine, see "main bench undo"
+    enum class UndoStrategy {COPY_MAKE, MAKE_UNMAKE};
+
+    // Build with -DUSE_MAKE_UNMAKE to make make/unmake the default
+#ifdef USE_MAKE_UNMAKE
+    constexpr UndoStrategy DEFAULT_UNDO_STRATEGY = UndoStrategy::MAKE_UNMAKE;
+#else
+    constexpr UndoStrategy DEFAULT_UNDO_STRATEGY = UndoStrategy::COPY_MAKE;
+#endif
+
+    // Number of leaf nodes depth plies below position. The last ply is bulk counted:
+    // the size of the legal move list is used rather than making each move
+    template <UndoStrategy strategy = DEFAULT_UNDO_STRATEGY>
+    uint64_t CountNodes(const Position &position, int depth);
+
+    // CountNodes, but looking up and storing the count of every subtree of depth 2 or more in table
+    uint64_t CountNodesHashed(const Position &position, int depth, PerftTable &table, PerftTable::Stats &stats);
+
+    // CountNodes split across threadCount threads. Every position splitDepth plies below the root
+    // becomes a task with its own copy of the position, run by a work-stealing pool. If table is
+    // given, all threads share it and their hit counts are added to stats
+    uint64_t CountNodesParallel(const Position &position, int depth, int threadCount, int splitDepth,
+                                PerftTable *table = nullptr, PerftTable::Stats *stats = nullptr);
+
+    // Prints every root move with the node count below it, then the total
+    uint64_t Divide(const Position &position, int depth);
+
+    // Runs CountNodesParallel and prints the count, time and nodes/sec. A hashMB above 0
+    // allocates a perft table of that size and also prints its hit rate
+    uint64_t Run(const Position &position, int depth, int threadCount = 1, int splitDepth = 2, int hashMB = 0);
+
+    // Times the same perft with 1, 2, 4, ... threads up to maxThreads and prints the speedup over
+    // one thread. Returns false if any thread count gives a different total
+    bool RunScaling(const Position &position, int depth, int maxThreads, int splitDepth = 2);
+
+    // Checks each test position at every depth up to maxDepth for which a count is listed,
+    // printing the results. Returns true if every count matches
+    bool RunSuite(int maxDepth);
+}
@@ -0,0 +1,50 @@
+#include "PerftTable.hpp"
+
+PerftTable::PerftTable(size_t sizeMB) {
+
+    bucketCount = 1;
+    while (bucketCount * 2 * sizeof(Bucket) <= sizeMB * 1024 * 1024)
+        bucketCount *= 2;
+
+    buckets.reset(new Bucket[bucketCount]);
+
+    // A zero entry decodes as depth 0, which is never stored, so it can never produce a hit
+    for (size_t i = 0; i < bucketCount; i++) {
+        for (VerifiedEntry &entry : buckets[i].entries)
+            entry.Clear();
+    }
+}
+
+
+PerftTable::Bucket &PerftTable::GetBucket(uint64_t key, int depth) const {
+
+    // Mix the depth in so the same position at different depths lands in different buckets
+    return buckets[(key ^ (depth * 0x9E3779B97F4A7C15ULL)) & (bucketCount - 1)];
+}
+
+
+bool PerftTable::Probe(uint64_t key, int depth, uint64_t &nodes) const {
+
+    for (const VerifiedEntry &entry : GetBucket(key, depth).entries) {
+
+        uint64_t data;
+        if (entry.Load(key, data) && static_cast<int>(data >> 56) == depth) {
+            nodes = data & ((1ULL << 56) - 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void PerftTable::Store(uint64_t key, int depth, uint64_t nodes) {
+
+    Bucket &bucket = GetBucket(key, depth);
+    uint64_t data = (static_cast<uint64_t>(depth) << 56) | nodes;
+
+    VerifiedEntry &deepest = bucket.entries[0];
+    VerifiedEntry &target = (depth >= static_cast<int>(deepest.LoadData() >> 56)) ? deepest : bucket.entries[1];
+
+    target.Store(key, data);
+}
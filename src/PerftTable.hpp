@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "VerifiedEntry.hpp"
+
+// Caches subtree node counts by (Zobrist key, depth) so transposed subtrees are only counted
+// once. It is shared by every perft thread without locks, through VerifiedEntry
+class PerftTable {
+
+    public:
+        // Hit counters, kept per thread and added up at the end
+        struct Stats {
+            uint64_t probes = 0;
+            uint64_t hits = 0;
+        };
+
+        // Allocates the largest power-of-two number of buckets that fits in sizeMB
+        explicit PerftTable(size_t sizeMB);
+
+        // Returns true and sets nodes if the count for (key, depth) is stored
+        bool Probe(uint64_t key, int depth, uint64_t &nodes) const;
+
+        void Store(uint64_t key, int depth, uint64_t nodes);
+
+        size_t GetSizeBytes() const {return bucketCount * sizeof(Bucket);}
+
+    private:
+        // Each entry's data packs the depth into the top 8 bits and the node count into the low 56.
+        // Slot 0 keeps the deepest subtree seen, slot 1 always takes the newest
+        struct alignas(32) Bucket {
+            VerifiedEntry entries[2];
+        };
+
+        Bucket &GetBucket(uint64_t key, int depth) const;
+
+    private:
+        std::unique_ptr<Bucket[]> buckets;
+        size_t bucketCount;
+};
@@ -0,0 +1,722 @@
+#include "Position.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include "LookupTables.hpp"
+#include "SlidingAttacks.hpp"
+
+// castlingRights is ANDed with the entries for both squares a move touches, so moving a king or
+// rook, or capturing a rook on its home square, removes the matching rights
+static constexpr std::array<int, 64> castlingRightsMask = [] {
+
+    std::array<int, 64> mask {};
+    for (auto &entry : mask)
+        entry = WHITE_KINGSIDE | WHITE_QUEENSIDE | BLACK_KINGSIDE | BLACK_QUEENSIDE;
+
+    mask[0] &= ~BLACK_QUEENSIDE;
+    mask[7] &= ~BLACK_KINGSIDE;
+    mask[4] &= ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+    mask[56] &= ~WHITE_QUEENSIDE;
+    mask[63] &= ~WHITE_KINGSIDE;
+    mask[60] &= ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+
+    return mask;
+}();
+
+Position::Position() {
+
+    SetFromFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
+
+
+// What each character of a FEN piece placement stands for: a Piece, a run of 1 to 8 empty
+// squares stored as EMPTY_RUN + n, a rank separator or nothing valid at all
+static constexpr uint8_t EMPTY_RUN = 16;
+static constexpr uint8_t RANK_SEPARATOR = 32;
+static constexpr uint8_t INVALID_CHAR = 255;
+
+static constexpr std::array<uint8_t, 256> fenCharTable = [] {
+
+    std::array<uint8_t, 256> table {};
+    for (auto &entry : table)
+        entry = INVALID_CHAR;
+
+    const char pieceChars[] = "PRNBQKprnbqk";
+    for (int piece = W_PAWN; piece <= B_KING; piece++)
+        table[static_cast<uint8_t>(pieceChars[piece])] = piece;
+
+    for (int run = 1; run <= 8; run++)
+        table['0' + run] = EMPTY_RUN + run;
+
+    table['/'] = RANK_SEPARATOR;
+
+    return table;
+}();
+
+
+// Removes and returns the next whitespace-separated field of text, or an empty view if there is none
+static std::string_view NextField(std::string_view &text) {
+
+    size_t start = 0;
+    while (start < text.size() && (text[start] == ' ' || text[start] == '\t' || text[start] == '\r' || text[start] == '\n'))
+        start++;
+
+    size_t end = start;
+    while (end < text.size() && text[end] != ' ' && text[end] != '\t' && text[end] != '\r' && text[end] != '\n')
+        end++;
+
+    std::string_view field = text.substr(start, end - start);
+    text.remove_prefix(end);
+
+    return field;
+}
+
+
+// Reads a clock of at most 65535, since the clocks are stored in 16 bits
+static bool ParseClock(std::string_view field, int &value) {
+
+    if (field.empty() || field.size() > 5)
+        return false;
+
+    value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + (c - '0');
+    }
+
+    return value <= 0xFFFF;
+}
+
+
+// Whether colour attacks squareIdx on a board given by one bitboard per Piece, for checking a
+// board before it is committed
+static bool IsSquareAttacked(const std::array<uint64_t, 12> &bitboards, int squareIdx, Colour colour) {
+
+    using namespace LookupTables;
+
+    int offset = (colour == WHITE) ? W_PAWN : B_PAWN;
+    uint64_t occupancy = 0ULL;
+    for (uint64_t bitboard : bitboards)
+        occupancy |= bitboard;
+
+    uint64_t pawnAttacks = (colour == WHITE) ? blackPawnAttackTable[squareIdx] : whitePawnAttackTable[squareIdx];
+    uint64_t rooks = bitboards[offset + ROOK] | bitboards[offset + QUEEN];
+    uint64_t bishops = bitboards[offset + BISHOP] | bitboards[offset + QUEEN];
+
+    return (pawnAttacks & bitboards[offset + PAWN])
+        || (knightLookupTable[squareIdx] & bitboards[offset + KNIGHT])
+        || (kingLookupTable[squareIdx] & bitboards[offset + KING])
+        || (SlidingAttacks::GetRookAttacks(squareIdx, occupancy) & rooks)
+        || (SlidingAttacks::GetBishopAttacks(squareIdx, occupancy) & bishops);
+}
+
+
+// Whether colour has no more material than promotions can give it: at most 8 pawns, and no more
+// queens, rooks, bishops and knights beyond the starting set than it has pawns missing. This
+// also limits it to 16 pieces, and keeps the number of legal moves within MoveList's capacity
+static bool IsMaterialPossible(const std::array<uint64_t, 12> &bitboards, Colour colour) {
+
+    int offset = (colour == WHITE) ? W_PAWN : B_PAWN;
+    int pawns = __builtin_popcountll(bitboards[offset + PAWN]);
+    int pieces = 0;
+    int promoted = 0;
+
+    for (PieceType type : {QUEEN, ROOK, BISHOP, KNIGHT}) {
+        int count = __builtin_popcountll(bitboards[offset + type]);
+        int startingCount = (type == QUEEN) ? 1 : 2;
+        pieces += count;
+        promoted += std::max(0, count - startingCount);
+    }
+
+    return pawns <= 8 && 1 + pawns + pieces <= 16 && promoted <= 8 - pawns;
+}
+
+
+// The checks a board must pass before move generation can be trusted with it. Exactly one king
+// each, no pawn on either back rank, material that promotions could have given and the side not
+// to move not in check, or the generator would capture a king. An en passant square must be behind an enemy pawn that has just moved
+// two squares, with both squares it crossed empty, or MakeMove would remove a pawn that is not there
+static FenError ValidateBoard(const std::array<uint64_t, 12> &bitboards, Colour activeColour, int enPassantSquare) {
+
+    if (__builtin_popcountll(bitboards[W_KING]) != 1 || __builtin_popcountll(bitboards[B_KING]) != 1)
+        return FenError::BAD_KINGS;
+
+    if ((bitboards[W_PAWN] | bitboards[B_PAWN]) & (LookupTables::Rank1 | LookupTables::Rank8))
+        return FenError::BAD_PAWNS;
+
+    if (!IsMaterialPossible(bitboards, WHITE) || !IsMaterialPossible(bitboards, BLACK))
+        return FenError::BAD_MATERIAL;
+
+    // The en passant square is on the sixth rank with white to move and the third with black to move
+    if (enPassantSquare != NO_SQUARE) {
+
+        uint64_t allowedRank = (activeColour == WHITE) ? LookupTables::Rank6 : LookupTables::Rank3;
+        int pushedSquare = enPassantSquare + ((activeColour == WHITE) ? 8 : -8);
+        int originSquare = enPassantSquare + ((activeColour == WHITE) ? -8 : 8);
+
+        uint64_t occupancy = 0ULL;
+        for (uint64_t bitboard : bitboards)
+            occupancy |= bitboard;
+
+        if (!((1ULL << enPassantSquare) & allowedRank)
+            || !(bitboards[(activeColour == WHITE) ? B_PAWN : W_PAWN] & (1ULL << pushedSquare))
+            || (occupancy & ((1ULL << enPassantSquare) | (1ULL << originSquare))))
+        {
+            return FenError::BAD_EN_PASSANT;
+        }
+    }
+
+    Colour opponent = (activeColour == WHITE) ? BLACK : WHITE;
+    int opponentKingSquare = __builtin_ctzll(bitboards[(opponent == WHITE) ? W_KING : B_KING]);
+
+    if (IsSquareAttacked(bitboards, opponentKingSquare, activeColour))
+        return FenError::OPPONENT_IN_CHECK;
+
+    return FenError::NONE;
+}
+
+
+FenError Position::ParseFen(std::string_view fen) {
+
+    std::string_view placement = NextField(fen);
+    std::string_view colour = NextField(fen);
+    std::string_view castling = NextField(fen);
+    std::string_view enPassant = NextField(fen);
+
+    if (enPassant.empty())
+        return FenError::MISSING_FIELD;
+
+    // The board is built off to the side so that a bad FEN leaves the position unchanged
+    std::array<uint8_t, 64> newBoard;
+    std::array<uint64_t, 12> newBitboards {};
+    int squareIdx = 0;
+    int rankEnd = 8;
+
+    for (char c : placement) {
+
+        uint8_t code = fenCharTable[static_cast<uint8_t>(c)];
+
+        if (code == RANK_SEPARATOR) {
+            if (squareIdx != rankEnd || rankEnd == 64)
+                return FenError::BAD_PLACEMENT;
+            rankEnd += 8;
+        }
+
+        else if (code >= EMPTY_RUN && code < RANK_SEPARATOR) {
+            for (int run = code - EMPTY_RUN; run > 0; run--) {
+                if (squareIdx == rankEnd)
+                    return FenError::BAD_PLACEMENT;
+                newBoard[squareIdx++] = NO_PIECE;
+            }
+        }
+
+        else if (code != INVALID_CHAR && squareIdx < rankEnd) {
+            newBitboards[code] |= (1ULL << squareIdx);
+            newBoard[squareIdx++] = code;
+        }
+
+        else
+            return FenError::BAD_PLACEMENT;
+    }
+
+    if (squareIdx != 64)
+        return FenError::BAD_PLACEMENT;
+
+    if (colour != "w" && colour != "b")
+        return FenError::BAD_COLOUR;
+
+    int newCastlingRights = 0;
+    if (castling != "-") {
+        for (char c : castling) {
+            switch (c) {
+                case 'K' : newCastlingRights |= WHITE_KINGSIDE; break;
+                case 'Q' : newCastlingRights |= WHITE_QUEENSIDE; break;
+                case 'k' : newCastlingRights |= BLACK_KINGSIDE; break;
+                case 'q' : newCastlingRights |= BLACK_QUEENSIDE; break;
+                default : return FenError::BAD_CASTLING;
+            }
+        }
+    }
+
+    Colour newActiveColour = (colour == "w") ? WHITE : BLACK;
+
+    int newEnPassantSquare = NO_SQUARE;
+    if (enPassant != "-") {
+        newEnPassantSquare = ParseSquare(enPassant);
+        if (newEnPassantSquare == NO_SQUARE)
+            return FenError::BAD_EN_PASSANT;
+    }
+
+    FenError boardError = ValidateBoard(newBitboards, newActiveColour, newEnPassantSquare);
+    if (boardError != FenError::NONE)
+        return boardError;
+
+    // The clocks are often left off EPD-style strings
+    int halfMoves = 0, fullMoves = 1;
+    std::string_view halfMoveField = NextField(fen);
+    std::string_view fullMoveField = NextField(fen);
+
+    if (!halfMoveField.empty() && !ParseClock(halfMoveField, halfMoves))
+        return FenError::BAD_CLOCK;
+    if (!fullMoveField.empty() && (!ParseClock(fullMoveField, fullMoves) || fullMoves == 0))
+        return FenError::BAD_CLOCK;
+
+    if (!NextField(fen).empty())
+        return FenError::TRAILING_TEXT;
+
+    typeBitboards = {};
+    colourBitboards = {};
+    board = newBoard;
+
+    for (int piece = W_PAWN; piece <= B_KING; piece++)
+        TogglePiece(piece, newBitboards[piece]);
+
+    activeColour = newActiveColour;
+    castlingRights = newCastlingRights;
+    enPassantSquare = newEnPassantSquare;
+    halfMoveClock = halfMoves;
+    fullMove = fullMoves;
+
+    key = ComputeKey();
+    attackCacheValid = 0;
+
+    return FenError::NONE;
+}
+
+
+const char *Position::GetFenErrorName(FenError error) {
+
+    switch (error) {
+        case FenError::NONE : return "no error";
+        case FenError::MISSING_FIELD : return "fewer than four fields";
+        case FenError::BAD_PLACEMENT : return "piece placement is not eight ranks of eight squares";
+        case FenError::BAD_KINGS : return "each side needs exactly one king";
+        case FenError::BAD_PAWNS : return "pawn on the first or eighth rank";
+        case FenError::BAD_MATERIAL : return "a side has more pawns or promoted pieces than a game can produce";
+        case FenError::BAD_COLOUR : return "side to move is not w or b";
+        case FenError::BAD_CASTLING : return "castling rights are not - or a combination of KQkq";
+        case FenError::BAD_EN_PASSANT : return "en passant square is not - or behind a pawn that has just moved two squares";
+        case FenError::OPPONENT_IN_CHECK : return "the side not to move is in check";
+        case FenError::BAD_CLOCK : return "move clocks are not numbers from 0 to 65535";
+        case FenError::TRAILING_TEXT : return "text after the move clocks";
+    }
+
+    return "unknown error";
+}
+
+
+UndoInfo Position::MakeMove(const Move &move) {
+
+    Colour us = activeColour;
+    Colour them = (us == WHITE) ? BLACK : WHITE;
+    int from = move.GetFrom();
+    int to = move.GetTo();
+    int flag = move.GetFlag();
+
+    int piece = board[from];
+    int captureIdx = to;
+    int captured = board[to];
+
+    // The pawn taken en passant sits behind the destination square
+    if (flag == Move::EN_PASSANT) {
+        captureIdx = to + ((us == WHITE) ? 8 : -8);
+        captured = MakePiece(them, PAWN);
+    }
+
+    UndoInfo undo = {key, halfMoveClock, static_cast<uint8_t>(captured), castlingRights, enPassantSquare};
+    const Zobrist::Keys &keys = Zobrist::keys;
+    halfMoveClock++;
+
+    if (captured != NO_PIECE) {
+        RemovePiece(captureIdx);
+        key ^= keys.pieces[captured][captureIdx];
+        halfMoveClock = 0;
+    }
+
+    MovePiece(from, to);
+    key ^= keys.pieces[piece][from] ^ keys.pieces[piece][to];
+
+    if (piece == MakePiece(us, PAWN))
+        halfMoveClock = 0;
+
+    if (flag == Move::PROMOTION) {
+        int promoted = MakePiece(us, static_cast<PieceType>(move.GetPromotion()));
+        RemovePiece(to);
+        PutPiece(promoted, to);
+        key ^= keys.pieces[piece][to] ^ keys.pieces[promoted][to];
+    }
+
+    // The king has already moved; move the rook to the square it jumped over
+    else if (flag == Move::CASTLING) {
+        bool isKingside = (to % 8) == 6;
+        int rookFrom = isKingside ? to + 1 : to - 2;
+        int rookTo = isKingside ? to - 1 : to + 1;
+        int rook = MakePiece(us, ROOK);
+
+        MovePiece(rookFrom, rookTo);
+        key ^= keys.pieces[rook][rookFrom] ^ keys.pieces[rook][rookTo];
+    }
+
+    if (enPassantSquare != NO_SQUARE)
+        key ^= keys.enPassantFile[enPassantSquare % 8];
+
+    enPassantSquare = (flag == Move::DOUBLE_PUSH) ? (from + to) / 2 : NO_SQUARE;
+
+    if (enPassantSquare != NO_SQUARE)
+        key ^= keys.enPassantFile[enPassantSquare % 8];
+
+    key ^= keys.castling[castlingRights];
+    castlingRights &= castlingRightsMask[from] & castlingRightsMask[to];
+    key ^= keys.castling[castlingRights];
+
+    if (us == BLACK)
+        fullMove++;
+
+    activeColour = them;
+    key ^= keys.blackToMove;
+    attackCacheValid = 0;
+
+    CheckKey("MakeMove");
+    return undo;
+}
+
+
+void Position::UnmakeMove(const Move &move, const UndoInfo &undo) {
+
+    Colour them = activeColour;
+    Colour us = (them == WHITE) ? BLACK : WHITE;
+    int from = move.GetFrom();
+    int to = move.GetTo();
+    int flag = move.GetFlag();
+
+    activeColour = us;
+    castlingRights = undo.castlingRights;
+    enPassantSquare = undo.enPassantSquare;
+    halfMoveClock = undo.halfMoveClock;
+    key = undo.key;
+
+    if (us == BLACK)
+        fullMove--;
+
+    // Turn the promoted piece back into a pawn before moving it home
+    if (flag == Move::PROMOTION) {
+        RemovePiece(to);
+        PutPiece(MakePiece(us, PAWN), to);
+    }
+
+    else if (flag == Move::CASTLING) {
+        bool isKingside = (to % 8) == 6;
+        int rookFrom = isKingside ? to + 1 : to - 2;
+        int rookTo = isKingside ? to - 1 : to + 1;
+
+        MovePiece(rookTo, rookFrom);
+    }
+
+    MovePiece(to, from);
+
+    if (undo.captured != NO_PIECE) {
+        int captureIdx = (flag == Move::EN_PASSANT) ? to + ((us == WHITE) ? 8 : -8) : to;
+        PutPiece(undo.captured, captureIdx);
+    }
+
+    attackCacheValid = 0;
+
+    CheckKey("UnmakeMove");
+}
+
+
+// Writes value in decimal at buffer and returns the number of digits written
+static size_t WriteNumber(char *buffer, unsigned value) {
+
+    char digits[10];
+    size_t count = 0;
+
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    for (size_t i = 0; i < count; i++)
+        buffer[i] = digits[count - 1 - i];
+
+    return count;
+}
+
+
+size_t Position::WriteFen(char *buffer, size_t bufferSize) const {
+
+    if (bufferSize < MAX_FEN_SIZE)
+        return 0;
+
+    const char pieceChars[] = "PRNBQKprnbqk";
+    char *cursor = buffer;
+    int emptySquares = 0;
+
+    for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+
+        int piece = board[squareIdx];
+
+        if (piece == NO_PIECE)
+            emptySquares++;
+        else {
+            if (emptySquares > 0)
+                *cursor++ = static_cast<char>('0' + emptySquares);
+            emptySquares = 0;
+            *cursor++ = pieceChars[piece];
+        }
+
+        // End of the row
+        if (squareIdx % 8 == 7) {
+            if (emptySquares > 0)
+                *cursor++ = static_cast<char>('0' + emptySquares);
+            emptySquares = 0;
+            if (squareIdx != 63)
+                *cursor++ = '/';
+        }
+    }
+
+    *cursor++ = ' ';
+    *cursor++ = (activeColour == WHITE) ? 'w' : 'b';
+    *cursor++ = ' ';
+
+    if (castlingRights & WHITE_KINGSIDE) *cursor++ = 'K';
+    if (castlingRights & WHITE_QUEENSIDE) *cursor++ = 'Q';
+    if (castlingRights & BLACK_KINGSIDE) *cursor++ = 'k';
+    if (castlingRights & BLACK_QUEENSIDE) *cursor++ = 'q';
+    if (castlingRights == 0) *cursor++ = '-';
+
+    *cursor++ = ' ';
+    if (enPassantSquare == NO_SQUARE)
+        *cursor++ = '-';
+    else {
+        *cursor++ = static_cast<char>('a' + enPassantSquare % 8);
+        *cursor++ = static_cast<char>('8' - enPassantSquare / 8);
+    }
+
+    *cursor++ = ' ';
+    cursor += WriteNumber(cursor, halfMoveClock);
+    *cursor++ = ' ';
+    cursor += WriteNumber(cursor, fullMove);
+    *cursor = '\0';
+
+    return cursor - buffer;
+}
+
+
+std::string Position::ToFen() const {
+
+    char buffer[MAX_FEN_SIZE];
+    size_t length = WriteFen(buffer, sizeof(buffer));
+
+    return std::string(buffer, length);
+}
+
+
+bool Position::ToPacked(PackedPosition &packed) const {
+
+    uint64_t occupancy = GetAllPieces();
+    if (__builtin_popcountll(occupancy) > PackedPosition::MAX_PIECES)
+        return false;
+
+    packed = {};
+    packed.occupancy = occupancy;
+
+    for (int pieceIdx = 0; occupancy; pieceIdx++) {
+        int squareIdx = __builtin_ctzll(occupancy);
+        packed.pieces[pieceIdx / 2] |= board[squareIdx] << (4 * (pieceIdx % 2));
+        occupancy &= occupancy - 1;
+    }
+
+    packed.halfMoveClock = halfMoveClock;
+    packed.fullMove = fullMove;
+    packed.flags = activeColour | (castlingRights << 1);
+    packed.enPassantFile = (enPassantSquare == NO_SQUARE) ? 8 : enPassantSquare % 8;
+
+    return true;
+}
+
+
+bool Position::SetFromPacked(const PackedPosition &packed) {
+
+    uint64_t occupancy = packed.occupancy;
+    if (__builtin_popcountll(occupancy) > PackedPosition::MAX_PIECES || packed.flags > 31 ||
+        packed.enPassantFile > 8 || packed.fullMove == 0)
+    {
+        return false;
+    }
+
+    std::array<uint8_t, 64> newBoard;
+    std::array<uint64_t, 12> newBitboards {};
+    newBoard.fill(NO_PIECE);
+
+    for (int pieceIdx = 0; occupancy; pieceIdx++) {
+        int squareIdx = __builtin_ctzll(occupancy);
+        int piece = (packed.pieces[pieceIdx / 2] >> (4 * (pieceIdx % 2))) & 0xF;
+
+        if (piece > B_KING)
+            return false;
+
+        newBoard[squareIdx] = piece;
+        newBitboards[piece] |= 1ULL << squareIdx;
+        occupancy &= occupancy - 1;
+    }
+
+    Colour newActiveColour = static_cast<Colour>(packed.flags & 1);
+    int newEnPassantSquare = (packed.enPassantFile == 8) ? NO_SQUARE
+                           : packed.enPassantFile + ((newActiveColour == WHITE) ? 16 : 40);
+
+    // The same checks ParseFen makes, so that a record from an untrusted file is always safe to search
+    if (ValidateBoard(newBitboards, newActiveColour, newEnPassantSquare) != FenError::NONE)
+        return false;
+
+    typeBitboards = {};
+    colourBitboards = {};
+    board = newBoard;
+
+    for (int piece = W_PAWN; piece <= B_KING; piece++)
+        TogglePiece(piece, newBitboards[piece]);
+
+    activeColour = newActiveColour;
+    castlingRights = packed.flags >> 1;
+    enPassantSquare = newEnPassantSquare;
+    halfMoveClock = packed.halfMoveClock;
+    fullMove = packed.fullMove;
+
+    key = ComputeKey();
+    attackCacheValid = 0;
+
+    return true;
+}
+
+
+uint64_t Position::ComputeKey() const {
+
+    uint64_t key = 0ULL;
+
+    for (int piece = 0; piece < 12; piece++) {
+        uint64_t bitboard = GetPieces(piece);
+        while (bitboard) {
+            key ^= Zobrist::keys.pieces[piece][__builtin_ctzll(bitboard)];
+            bitboard &= bitboard - 1;
+        }
+    }
+
+    key ^= Zobrist::keys.castling[castlingRights];
+
+    if (enPassantSquare != NO_SQUARE)
+        key ^= Zobrist::keys.enPassantFile[enPassantSquare % 8];
+
+    if (activeColour == BLACK)
+        key ^= Zobrist::keys.blackToMove;
+
+    return key;
+}
+
+
+uint64_t Position::GetAttackersTo(int squareIdx, uint64_t occupancy) const {
+
+    using namespace LookupTables;
+
+    uint64_t rooks = typeBitboards[ROOK] | typeBitboards[QUEEN];
+    uint64_t bishops = typeBitboards[BISHOP] | typeBitboards[QUEEN];
+
+    // A white pawn attacks squareIdx if a black pawn on squareIdx would attack it, and vice versa
+    return (blackPawnAttackTable[squareIdx] & GetPieces(WHITE, PAWN))
+         | (whitePawnAttackTable[squareIdx] & GetPieces(BLACK, PAWN))
+         | (knightLookupTable[squareIdx] & typeBitboards[KNIGHT])
+         | (kingLookupTable[squareIdx] & typeBitboards[KING])
+         | (SlidingAttacks::GetRookAttacks(squareIdx, occupancy) & rooks)
+         | (SlidingAttacks::GetBishopAttacks(squareIdx, occupancy) & bishops);
+}
+
+
+uint64_t Position::ComputeAttackedSquares(Colour colour, uint64_t occupancy) const {
+
+    using namespace LookupTables;
+
+    // Pawn attacks for the whole side at once, masking the source file so nothing wraps around
+    uint64_t pawns = GetPieces(colour, PAWN);
+    uint64_t attacks = (colour == WHITE) ? ((pawns & ~AFile) >> 9) | ((pawns & ~HFile) >> 7)
+                                         : ((pawns & ~AFile) << 7) | ((pawns & ~HFile) << 9);
+
+    uint64_t knights = GetPieces(colour, KNIGHT);
+    while (knights) {
+        attacks |= knightLookupTable[__builtin_ctzll(knights)];
+        knights &= knights - 1;
+    }
+
+    uint64_t queens = GetPieces(colour, QUEEN);
+
+    uint64_t bishops = GetPieces(colour, BISHOP) | queens;
+    while (bishops) {
+        attacks |= SlidingAttacks::GetBishopAttacks(__builtin_ctzll(bishops), occupancy);
+        bishops &= bishops - 1;
+    }
+
+    uint64_t rooks = GetPieces(colour, ROOK) | queens;
+    while (rooks) {
+        attacks |= SlidingAttacks::GetRookAttacks(__builtin_ctzll(rooks), occupancy);
+        rooks &= rooks - 1;
+    }
+
+    return attacks | kingLookupTable[GetKingSquare(colour)];
+}
+
+
+uint64_t Position::GetAttackedSquares(Colour colour) const {
+
+    if (!(attackCacheValid & (1 << colour))) {
+        attackCache[colour] = ComputeAttackedSquares(colour, GetAllPieces());
+        attackCacheValid |= (1 << colour);
+    }
+
+    return attackCache[colour];
+}
+
+
+uint64_t Position::GetKingDangerSquares() const {
+
+    if (!(attackCacheValid & (1 << KING_DANGER))) {
+        Colour them = (activeColour == WHITE) ? BLACK : WHITE;
+        uint64_t occupancyWithoutKing = GetAllPieces() ^ GetPieces(activeColour, KING);
+
+        attackCache[KING_DANGER] = ComputeAttackedSquares(them, occupancyWithoutKing);
+        attackCacheValid |= (1 << KING_DANGER);
+    }
+
+    return attackCache[KING_DANGER];
+}
+
+
+std::string Position::SquareName(int squareIdx) {
+
+    std::string name;
+    name += static_cast<char>('a' + squareIdx % 8);
+    name += static_cast<char>('8' - squareIdx / 8);
+
+    return name;
+}
+
+
+int Position::ParseSquare(std::string_view name) {
+
+    if (name.size() != 2 || name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8')
+        return NO_SQUARE;
+
+    return (name[0] - 'a') + ('8' - name[1]) * 8;
+}
+
+
+void Position::CheckKey(const char *caller) const {
+
+#ifdef DEBUG_ZOBRIST
+    if (key != ComputeKey()) {
+        std::cerr << caller << ": incremental Zobrist key " << std::hex << key << " differs from recomputed key "
+                  << ComputeKey() << std::dec << " in " << ToFen() << std::endl;
+        std::abort();
+    }
+#else
+    (void)caller;
+#endif
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "Move.hpp"
+#include "PackedPosition.hpp"
+#include "Zobrist.hpp"
+
+// One byte, so that Position stays packed
+enum Colour : uint8_t {WHITE, BLACK};
+
+// In the same order as Game's pieceArray, so piece index = colour * 6 + piece type
+enum PieceType {PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING};
+
+enum Piece {W_PAWN, W_ROOK, W_KNIGHT, W_BISHOP, W_QUEEN, W_KING,
+            B_PAWN, B_ROOK, B_KNIGHT, B_BISHOP, B_QUEEN, B_KING,
+            NO_PIECE};
+
+enum CastlingRight {WHITE_KINGSIDE = 1, WHITE_QUEENSIDE = 2, BLACK_KINGSIDE = 4, BLACK_QUEENSIDE = 8};
+
+// Used for the en passant square when there is none
+constexpr int NO_SQUARE = 64;
+
+inline int MakePiece(Colour colour, PieceType type) {return colour * 6 + type;}
+
+
+// What MakeMove overwrites, so that UnmakeMove can put it back. 16 bytes
+struct UndoInfo {
+    uint64_t key;
+    uint16_t halfMoveClock;
+    uint8_t captured;
+    uint8_t castlingRights;
+    uint8_t enPassantSquare;
+};
+
+static_assert(sizeof(UndoInfo) == 16, "UndoInfo should stay compact");
+
+
+// Why a FEN string was rejected
+enum class FenError {NONE, MISSING_FIELD, BAD_PLACEMENT, BAD_KINGS, BAD_PAWNS, BAD_MATERIAL,
+                     BAD_COLOUR, BAD_CASTLING, BAD_EN_PASSANT, OPPONENT_IN_CHECK, BAD_CLOCK, TRAILING_TEXT};
+
+
+// The board state without any rendering or input, so it can be used headlessly.
+// Square 0 is a8 and square 63 is h1, as in the FEN piece placement.
+// Positions are trivially copyable and exactly three cache lines, so copy-make is three
+// line copies and positions can be kept in arrays, memcpy'd or handed to other threads
+class alignas(64) Position {
+
+    public:
+        // Sets up the starting position
+        Position();
+
+        // Sets the position from fen without allocating. On an error the position is left unchanged.
+        // The move clocks are optional, and default to 0 and 1
+        FenError ParseFen(std::string_view fen);
+
+        // ParseFen, for callers that only need to know whether it worked
+        bool SetFromFen(std::string_view fen) {return ParseFen(fen) == FenError::NONE;}
+
+        // A short description of error, for messages
+        static const char *GetFenErrorName(FenError error);
+
+        // Plays a legal move from GenerateLegalMoves, updating every part of the state.
+        // The returned record is only needed to take the move back with UnmakeMove
+        UndoInfo MakeMove(const Move &move);
+
+        // Takes back move, which must be the last move made, restoring the state from undo
+        void UnmakeMove(const Move &move, const UndoInfo &undo);
+
+        // Longest possible FEN, with a full board, all castling rights, an en passant
+        // square and five-digit clocks, plus the terminating null
+        static constexpr size_t MAX_FEN_SIZE = 94;
+
+        // Writes the position as a null-terminated FEN string into buffer, without allocating,
+        // and returns its length. Writes nothing and returns 0 if bufferSize is below MAX_FEN_SIZE
+        size_t WriteFen(char *buffer, size_t bufferSize) const;
+
+        // The position as a FEN string, for when an allocation does not matter
+        std::string ToFen() const;
+
+        // The position in 32 bytes. Returns false, leaving packed unchanged, if there are
+        // more pieces than PackedPosition::MAX_PIECES
+        bool ToPacked(PackedPosition &packed) const;
+
+        // Returns false, leaving the position unchanged, if packed is not a valid record
+        bool SetFromPacked(const PackedPosition &packed);
+
+        /* GETTERS */
+        uint64_t GetPieces(int piece) const {return typeBitboards[piece % 6] & colourBitboards[piece / 6];}
+        uint64_t GetPieces(Colour colour, PieceType type) const {return typeBitboards[type] & colourBitboards[colour];}
+        uint64_t GetPieces(PieceType type) const {return typeBitboards[type];}
+        uint64_t GetColourPieces(Colour colour) const {return colourBitboards[colour];}
+        uint64_t GetAllPieces() const {return colourBitboards[WHITE] | colourBitboards[BLACK];}
+
+        Colour GetActiveColour() const {return activeColour;}
+        int GetCastlingRights() const {return castlingRights;}
+        int GetEnPassantSquare() const {return enPassantSquare;}
+        int GetHalfMoveClock() const {return halfMoveClock;}
+        int GetFullMove() const {return fullMove;}
+
+        // Zobrist key, kept up to date by MakeMove and UnmakeMove
+        uint64_t GetKey() const {return key;}
+
+        // Zobrist key of the whole position, computed from scratch
+        uint64_t ComputeKey() const;
+
+        // Returns the piece on squareIdx, or NO_PIECE
+        int GetPieceOn(int squareIdx) const {return board[squareIdx];}
+
+        // Square index of colour's king
+        int GetKingSquare(Colour colour) const {return __builtin_ctzll(GetPieces(colour, KING));}
+
+        /* ATTACKS */
+        // Every piece, of either colour, attacking squareIdx, with sliders blocked by occupancy
+        uint64_t GetAttackersTo(int squareIdx, uint64_t occupancy) const;
+        uint64_t GetAttackersTo(int squareIdx) const {return GetAttackersTo(squareIdx, GetAllPieces());}
+
+        // Every square colour attacks. Worked out on the first call after a move and cached,
+        // so later calls in the same position cost one load. Not safe to call on one Position
+        // from several threads at once
+        uint64_t GetAttackedSquares(Colour colour) const;
+
+        // Squares attacked by the side not to move, with the side to move's king taken off the
+        // board so that it cannot hide from a slider behind itself. The king may move to or
+        // castle across any other square. Cached like GetAttackedSquares
+        uint64_t GetKingDangerSquares() const;
+
+        bool IsSquareAttacked(int squareIdx, Colour byColour) const {return (GetAttackedSquares(byColour) >> squareIdx) & 1;}
+        bool IsInCheck() const {return IsSquareAttacked(GetKingSquare(activeColour), activeColour == WHITE ? BLACK : WHITE);}
+
+        /* SQUARE NAMES */
+        // e.g. 52 -> "e2"
+        static std::string SquareName(int squareIdx);
+
+        // e.g. "e2" -> 52. Returns NO_SQUARE if name is not a square
+        static int ParseSquare(std::string_view name);
+
+    private:
+        // Adds or removes piece on every square of bits
+        void TogglePiece(int piece, uint64_t bits) {
+            typeBitboards[piece % 6] ^= bits;
+            colourBitboards[piece / 6] ^= bits;
+        }
+
+        // Update the bitboards and the board array together
+        void PutPiece(int piece, int squareIdx) {
+            TogglePiece(piece, 1ULL << squareIdx);
+            board[squareIdx] = piece;
+        }
+
+        void RemovePiece(int squareIdx) {
+            TogglePiece(board[squareIdx], 1ULL << squareIdx);
+            board[squareIdx] = NO_PIECE;
+        }
+
+        void MovePiece(int from, int to) {
+            TogglePiece(board[from], (1ULL << from) | (1ULL << to));
+            board[to] = board[from];
+            board[from] = NO_PIECE;
+        }
+
+        // With DEBUG_ZOBRIST defined, aborts if key differs from ComputeKey()
+        void CheckKey(const char *caller) const;
+
+        // Every square colour attacks, with sliders blocked by occupancy
+        uint64_t ComputeAttackedSquares(Colour colour, uint64_t occupancy) const;
+
+    private:
+        // A piece's bitboard is its type's bitboard ANDed with its colour's
+        std::array<uint64_t, 6> typeBitboards;
+        std::array<uint64_t, 2> colourBitboards;
+
+        // The piece on each square, or NO_PIECE, mirroring the bitboards
+        std::array<uint8_t, 64> board;
+
+        uint64_t key;
+
+        // Attack maps: [WHITE], [BLACK] and [KING_DANGER]. Bit i of attackCacheValid is set
+        // once entry i has been computed, and the whole cache is dropped by every move
+        enum {KING_DANGER = 2};
+        mutable std::array<uint64_t, 3> attackCache;
+
+        uint16_t halfMoveClock;
+        uint16_t fullMove;
+        Colour activeColour;
+
+        // A combination of CastlingRight flags
+        uint8_t castlingRights;
+        uint8_t enPassantSquare;
+        mutable uint8_t attackCacheValid;
+};
+
+static_assert(std::is_trivially_copyable_v<Position>, "Position must be copyable with memcpy");
+static_assert(sizeof(Position) == 192, "Position should fill exactly three cache lines");
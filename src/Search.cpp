@@ -0,0 +1,565 @@
+#include "Search.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include "Evaluation.hpp"
+#include "MovePicker.hpp"
+#include "StaticExchange.hpp"
+
+// The time and the other threads' node counts are only read every CHECK_INTERVAL nodes, as
+// reading them costs more than a node
+static constexpr uint64_t CHECK_INTERVAL = 1024;
+
+class Searcher;
+
+
+// What every thread of one search shares. Only the table and the stop flag are written during the search
+struct SharedSearchState {
+    SearchLimits limits;
+    TranspositionTable &table;
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<bool> isStopped;
+
+    // One per thread, the main thread's first
+    std::vector<std::unique_ptr<Searcher>> searchers;
+};
+
+
+// One thread's search of one position, with everything it writes as it searches. Kept out of
+// the header as it holds nothing callers need. Aligned to a cache line, so that two threads'
+// searchers never share one and their counters do not bounce between cores
+class alignas(64) Searcher {
+
+    public:
+        Searcher(const Position &position, SharedSearchState &shared, int threadIdx);
+
+        // Iterative deepening until the limits are reached or, for a helper thread, until the
+        // main thread stops the search. Only the main thread reports iterations
+        SearchResult Run(const IterationCallback &onIteration);
+
+        uint64_t GetNodes() const {return nodes.load(std::memory_order_relaxed);}
+        uint64_t GetTtProbes() const {return ttProbes;}
+        uint64_t GetTtHits() const {return ttHits;}
+        uint64_t GetCutoffs() const {return cutoffs;}
+        uint64_t GetFirstMoveCutoffs() const {return firstMoveCutoffs;}
+
+    private:
+        int Negamax(int depth, int ply, int alpha, int beta);
+
+        // Searches captures, or every evasion when in check, until the position is quiet
+        int Quiescence(int ply, int alpha, int beta);
+
+        // Counts a node and returns whether to stop. The main thread also checks the limits,
+        // and stops every thread once one is reached
+        bool CountNodeAndCheckLimits();
+
+        // Nodes searched by every thread so far
+        uint64_t GetTotalNodes() const;
+
+        // Fifty moves without a capture or pawn move, or a repetition since the root
+        bool IsDraw(int ply) const;
+
+        double GetElapsedSeconds() const;
+
+        // Looks up the current position, counting the probe and any hit
+        bool ProbeTable(TranspositionTable::Data &data);
+
+        // Continues a PV cut short by a hash cutoff with the exact entries' moves from the table
+        void ExtendPvFromTable(std::vector<Move> &line) const;
+
+        // Rewards the quiet move that caused a beta cutoff at ply as a killer, counter move and in
+        // the history, and lowers the history of the quiet moves searched before it
+        void UpdateQuietStats(int depth, int ply, Move move, const Move *failedQuiets, int failedQuietCount);
+
+    private:
+        Position position;
+        SharedSearchState &shared;
+        const SearchLimits &limits;
+        TranspositionTable &table;
+        int threadIdx;
+
+        // Written only by this thread, but read by the main thread for the node limit and reports
+        std::atomic<uint64_t> nodes;
+        uint64_t ttProbes;
+        uint64_t ttHits;
+        bool isStopped;
+
+        // Beta cutoffs, and how many of them came from the first move searched, which shows how good the ordering is
+        uint64_t cutoffs;
+        uint64_t firstMoveCutoffs;
+
+        // Move ordering statistics. Each thread learns its own, so no thread waits on another
+        std::array<std::array<Move, 2>, MAX_PLY + 1> killers;
+        ButterflyHistory history;
+        CounterMoveTable counterMoves;
+
+        // The move made at each ply of the current line and the piece that made it, for looking up counter moves
+        std::array<Move, MAX_PLY + 1> lineMoves;
+        std::array<int, MAX_PLY + 1> linePieces;
+
+        // Key of the position at each ply of the current line, for finding repetitions
+        std::array<uint64_t, MAX_PLY + 1> keys;
+
+        // Triangular PV table: pv[ply] holds the best line found from ply, pvLength[ply] moves long
+        std::array<std::array<Move, MAX_PLY + 1>, MAX_PLY + 1> pv;
+        std::array<int, MAX_PLY + 1> pvLength;
+};
+
+
+// Mate scores are stored relative to the node rather than the root, as the same position can be
+// reached at different plies
+static int ScoreToTable(int score, int ply) {
+    return (score >= MATE_BOUND) ? score + ply : (score <= -MATE_BOUND) ? score - ply : score;
+}
+
+
+static int ScoreFromTable(int score, int ply) {
+    return (score >= MATE_BOUND) ? score - ply : (score <= -MATE_BOUND) ? score + ply : score;
+}
+
+
+// Whether a stored score, searched at least as deep as needed, settles the node's score for the window alpha to beta
+static bool IsUsableBound(const TranspositionTable::Data &data, int score, int alpha, int beta) {
+    return data.bound == TranspositionTable::BOUND_EXACT
+        || (data.bound == TranspositionTable::BOUND_LOWER && score >= beta)
+        || (data.bound == TranspositionTable::BOUND_UPPER && score <= alpha);
+}
+
+
+Searcher::Searcher(const Position &position, SharedSearchState &shared, int threadIdx) :
+    position(position), shared(shared), limits(shared.limits), table(shared.table), threadIdx(threadIdx),
+    nodes(0), ttProbes(0), ttHits(0), isStopped(false), cutoffs(0), firstMoveCutoffs(0)
+{
+    for (auto &plyKillers : killers)
+        plyKillers.fill(Move::None());
+    for (auto &pieceCounterMoves : counterMoves)
+        pieceCounterMoves.fill(Move::None());
+}
+
+
+double Searcher::GetElapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+}
+
+
+uint64_t Searcher::GetTotalNodes() const {
+
+    uint64_t total = 0;
+    for (const auto &searcher : shared.searchers)
+        total += searcher->GetNodes();
+
+    return total;
+}
+
+
+bool Searcher::CountNodeAndCheckLimits() {
+
+    // Only this thread writes its count, so a load and a store are enough
+    uint64_t nodeCount = nodes.load(std::memory_order_relaxed) + 1;
+    nodes.store(nodeCount, std::memory_order_relaxed);
+
+    if (threadIdx == 0) {
+
+        // Alone, the main thread's count is the total, so the node limit can be kept exactly
+        bool isSingleThread = shared.searchers.size() == 1;
+
+        if (limits.nodes && (isSingleThread || nodeCount % CHECK_INTERVAL == 0)
+            && (isSingleThread ? nodeCount : GetTotalNodes()) >= limits.nodes)
+            shared.isStopped.store(true, std::memory_order_relaxed);
+
+        if (limits.timeMs && nodeCount % CHECK_INTERVAL == 0 && GetElapsedSeconds() * 1000.0 >= limits.timeMs)
+            shared.isStopped.store(true, std::memory_order_relaxed);
+    }
+
+    isStopped = shared.isStopped.load(std::memory_order_relaxed);
+    return isStopped;
+}
+
+
+bool Searcher::ProbeTable(TranspositionTable::Data &data) {
+
+    ttProbes++;
+    bool isHit = table.Probe(position.GetKey(), data);
+    ttHits += isHit;
+
+    return isHit;
+}
+
+
+void Searcher::ExtendPvFromTable(std::vector<Move> &line) const {
+
+    Position linePosition = position;
+    std::vector<uint64_t> lineKeys = {linePosition.GetKey()};
+
+    for (Move move : line) {
+        linePosition.MakeMove(move);
+        lineKeys.push_back(linePosition.GetKey());
+    }
+
+    // Stopping at a repetition keeps a drawn cycle from repeating up to MAX_PLY
+    TranspositionTable::Data data;
+
+    while (static_cast<int>(line.size()) < MAX_PLY && table.Probe(linePosition.GetKey(), data)
+           && data.bound == TranspositionTable::BOUND_EXACT && MoveGeneration::IsLegal(linePosition, data.move)) {
+
+        linePosition.MakeMove(data.move);
+        if (std::find(lineKeys.begin(), lineKeys.end(), linePosition.GetKey()) != lineKeys.end())
+            break;
+
+        line.push_back(data.move);
+        lineKeys.push_back(linePosition.GetKey());
+    }
+}
+
+
+// History reward for a cutoff at depth. Deeper cutoffs save more work, so they count for more
+static int HistoryBonus(int depth) {
+    return std::min(32 * depth * depth, ButterflyHistory::MAX_HISTORY / 2);
+}
+
+
+void Searcher::UpdateQuietStats(int depth, int ply, Move move, const Move *failedQuiets, int failedQuietCount) {
+
+    if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    if (ply > 0)
+        counterMoves[linePieces[ply - 1]][lineMoves[ply - 1].GetTo()] = move;
+
+    Colour side = position.GetActiveColour();
+    int bonus = HistoryBonus(depth);
+
+    history.Update(side, move, bonus);
+    for (int i = 0; i < failedQuietCount; i++)
+        history.Update(side, failedQuiets[i], -bonus);
+}
+
+
+bool Searcher::IsDraw(int ply) const {
+
+    if (position.GetHalfMoveClock() >= 100)
+        return true;
+
+    // A position can only repeat with the same side to move, and not across a capture or pawn move
+    for (int previous = ply - 4; previous >= 0 && previous >= ply - position.GetHalfMoveClock(); previous -= 2) {
+        if (keys[previous] == keys[ply])
+            return true;
+    }
+
+    return false;
+}
+
+
+int Searcher::Quiescence(int ply, int alpha, int beta) {
+
+    pvLength[ply] = ply;
+
+    if (CountNodeAndCheckLimits())
+        return 0;
+
+    if (ply >= MAX_PLY)
+        return Evaluation::Evaluate(position);
+
+    // Every quiescence entry counts as depth 0, so any stored entry is deep enough
+    TranspositionTable::Data ttData;
+    bool isTtHit = ProbeTable(ttData);
+    int ttScore = isTtHit ? ScoreFromTable(ttData.score, ply) : 0;
+
+    if (isTtHit && IsUsableBound(ttData, ttScore, alpha, beta))
+        return ttScore;
+
+    // Standing pat: the side to move can usually do at least as well as its static score by
+    // not capturing. A side in check has no such choice
+    bool isInCheck = position.IsInCheck();
+    int staticEval = TranspositionTable::NO_EVAL;
+    int bestScore = -INFINITE_SCORE;
+    int originalAlpha = alpha;
+
+    if (!isInCheck) {
+        staticEval = (isTtHit && ttData.eval != TranspositionTable::NO_EVAL) ? ttData.eval : Evaluation::Evaluate(position);
+        bestScore = staticEval;
+
+        if (bestScore >= beta) {
+            table.Store(position.GetKey(), Move::None(), ScoreToTable(bestScore, ply), staticEval, 0, TranspositionTable::BOUND_LOWER);
+            return bestScore;
+        }
+        if (bestScore > alpha)
+            alpha = bestScore;
+    }
+
+    MovePicker picker(position, isTtHit ? ttData.move : Move::None());
+    Move bestMove = Move::None();
+    int moveCount = 0;
+    Move move;
+
+    while (!(move = picker.Next()).IsNone()) {
+
+        moveCount++;
+
+        // A capture that loses material by exchange rarely gets back above the stand-pat score
+        if (!isInCheck && !StaticExchange::IsAtLeast(position, move, 0))
+            continue;
+
+        UndoInfo undo = position.MakeMove(move);
+        table.Prefetch(position.GetKey());
+        int score = -Quiescence(ply + 1, -beta, -alpha);
+        position.UnmakeMove(move, undo);
+
+        if (isStopped)
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+                if (alpha >= beta)
+                    break;
+            }
+        }
+    }
+
+    if (isInCheck && moveCount == 0)
+        bestScore = -MATE_SCORE + ply;
+
+    TranspositionTable::Bound bound = (bestScore >= beta) ? TranspositionTable::BOUND_LOWER
+                                    : (bestScore > originalAlpha) ? TranspositionTable::BOUND_EXACT : TranspositionTable::BOUND_UPPER;
+    table.Store(position.GetKey(), bestMove, ScoreToTable(bestScore, ply), staticEval, 0, bound);
+
+    return bestScore;
+}
+
+
+int Searcher::Negamax(int depth, int ply, int alpha, int beta) {
+
+    if (depth <= 0)
+        return Quiescence(ply, alpha, beta);
+
+    pvLength[ply] = ply;
+
+    if (CountNodeAndCheckLimits())
+        return 0;
+
+    if (ply > 0 && IsDraw(ply))
+        return 0;
+
+    if (ply >= MAX_PLY)
+        return Evaluation::Evaluate(position);
+
+    // A stored score from a deep enough search ends the node, except at the root, which must
+    // come back with a move and its PV
+    TranspositionTable::Data ttData;
+    bool isTtHit = ProbeTable(ttData);
+
+    if (isTtHit && ply > 0 && ttData.depth >= depth) {
+        int ttScore = ScoreFromTable(ttData.score, ply);
+        if (IsUsableBound(ttData, ttScore, alpha, beta))
+            return ttScore;
+    }
+
+    // The table holds the previous iteration's PV, so its moves are tried first along it
+    Move counterMove = (ply > 0) ? counterMoves[linePieces[ply - 1]][lineMoves[ply - 1].GetTo()] : Move::None();
+    MovePicker picker(position, isTtHit ? ttData.move : Move::None(), killers[ply][0], killers[ply][1], counterMove, &history);
+
+    int bestScore = -INFINITE_SCORE;
+    int originalAlpha = alpha;
+    Move bestMove = Move::None();
+    int moveCount = 0;
+    Move move;
+
+    // Quiet moves searched without a cutoff, whose history is lowered if a later move cuts off
+    std::array<Move, 64> failedQuiets;
+    int failedQuietCount = 0;
+
+    while (!(move = picker.Next()).IsNone()) {
+
+        moveCount++;
+
+        bool isQuiet = !MoveGeneration::IsCapture(position, move);
+        lineMoves[ply] = move;
+        linePieces[ply] = position.GetPieceOn(move.GetFrom());
+
+        UndoInfo undo = position.MakeMove(move);
+        table.Prefetch(position.GetKey());
+        keys[ply + 1] = position.GetKey();
+        int score = -Negamax(depth - 1, ply + 1, -beta, -alpha);
+        position.UnmakeMove(move, undo);
+
+        if (isStopped)
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+
+                // The new best line is this move followed by the child's best line
+                pv[ply][ply] = move;
+                for (int next = ply + 1; next < pvLength[ply + 1]; next++)
+                    pv[ply][next] = pv[ply + 1][next];
+                pvLength[ply] = pvLength[ply + 1];
+
+                if (alpha >= beta) {
+                    cutoffs++;
+                    firstMoveCutoffs += (moveCount == 1);
+                    if (isQuiet)
+                        UpdateQuietStats(depth, ply, move, failedQuiets.data(), failedQuietCount);
+                    break;
+                }
+            }
+        }
+
+        if (isQuiet && failedQuietCount < static_cast<int>(failedQuiets.size()))
+            failedQuiets[failedQuietCount++] = move;
+    }
+
+    // Checkmate or stalemate. Nearer mates score further from 0, so the quickest mate is preferred
+    if (moveCount == 0)
+        bestScore = position.IsInCheck() ? -MATE_SCORE + ply : 0;
+
+    // A node that failed low has no best move, so the stored move is left as it was
+    TranspositionTable::Bound bound = (bestScore >= beta) ? TranspositionTable::BOUND_LOWER
+                                    : (bestScore > originalAlpha) ? TranspositionTable::BOUND_EXACT : TranspositionTable::BOUND_UPPER;
+    int eval = isTtHit ? ttData.eval : TranspositionTable::NO_EVAL;
+    table.Store(position.GetKey(), bestMove, ScoreToTable(bestScore, ply), eval, depth, bound);
+
+    return bestScore;
+}
+
+
+SearchResult Searcher::Run(const IterationCallback &onIteration) {
+
+    SearchResult result;
+    keys[0] = position.GetKey();
+
+    // Helpers search on until the main thread stops them. Every other helper searches each
+    // iteration one ply deeper, so the threads spread over two depths and the deeper ones leave
+    // results in the table that the shallower ones can use
+    bool isMainThread = (threadIdx == 0);
+    int maxDepth = (isMainThread && limits.depth > 0) ? std::min(limits.depth, MAX_PLY) : MAX_PLY;
+    int depthOffset = isMainThread ? 0 : threadIdx % 2;
+
+    for (int depth = 1; depth + depthOffset <= maxDepth; depth++) {
+
+        int score = Negamax(depth + depthOffset, 0, -INFINITE_SCORE, INFINITE_SCORE);
+
+        // An unfinished iteration is thrown away, unless there is nothing better to return
+        if (isStopped && !result.bestMove.IsNone())
+            break;
+
+        result.pv.assign(pv[0].begin(), pv[0].begin() + pvLength[0]);
+        ExtendPvFromTable(result.pv);
+        result.bestMove = result.pv.empty() ? Move::None() : result.pv[0];
+        result.score = score;
+        result.depth = depth + depthOffset;
+        result.nodes = GetTotalNodes();
+        result.seconds = GetElapsedSeconds();
+        result.ttProbes = ttProbes;
+        result.ttHits = ttHits;
+        result.hashfull = table.GetHashfull();
+        result.cutoffs = cutoffs;
+        result.firstMoveCutoffs = firstMoveCutoffs;
+
+        if (isStopped)
+            break;
+
+        if (onIteration && isMainThread)
+            onIteration(result);
+
+        // Nothing to search without moves, and no point searching past a forced mate
+        if (result.bestMove.IsNone() || std::abs(score) >= MATE_BOUND)
+            break;
+
+        // The next iteration would take several times longer than all of those so far
+        if (limits.timeMs && result.seconds * 1000.0 >= limits.timeMs / 2.0)
+            break;
+    }
+
+    // Stopped before the first move of the first iteration was searched; any legal move beats none
+    if (result.bestMove.IsNone() && isStopped) {
+        MoveList moves;
+        MoveGeneration::GenerateLegalMoves(position, moves);
+        if (moves.size())
+            result.pv = {result.bestMove = moves[0]};
+    }
+
+    result.nodes = GetTotalNodes();
+    result.seconds = GetElapsedSeconds();
+    result.ttProbes = ttProbes;
+    result.ttHits = ttHits;
+    result.hashfull = table.GetHashfull();
+    result.cutoffs = cutoffs;
+    result.firstMoveCutoffs = firstMoveCutoffs;
+
+    return result;
+}
+
+
+SearchResult Search(const Position &position, const SearchLimits &limits, TranspositionTable &table,
+                    int threadCount, const IterationCallback &onIteration) {
+
+    table.NewSearch();
+
+    SharedSearchState shared{limits, table, std::chrono::steady_clock::now(), {false}, {}};
+    threadCount = std::max(threadCount, 1);
+
+    for (int threadIdx = 0; threadIdx < threadCount; threadIdx++)
+        shared.searchers.push_back(std::make_unique<Searcher>(position, shared, threadIdx));
+
+    // Lazy SMP: the helpers search the same root on their own threads, and share nothing
+    // with the main thread but the table and the stop flag
+    std::vector<std::thread> helpers;
+    for (int threadIdx = 1; threadIdx < threadCount; threadIdx++)
+        helpers.emplace_back([&shared, threadIdx] {shared.searchers[threadIdx]->Run(nullptr);});
+
+    // The main thread decides when to stop, and its result is the one returned
+    SearchResult result = shared.searchers[0]->Run(onIteration);
+    shared.isStopped.store(true, std::memory_order_relaxed);
+
+    for (std::thread &helper : helpers)
+        helper.join();
+
+    result.nodes = 0;
+    result.ttProbes = 0;
+    result.ttHits = 0;
+    result.cutoffs = 0;
+    result.firstMoveCutoffs = 0;
+
+    for (const auto &searcher : shared.searchers) {
+        result.nodes += searcher->GetNodes();
+        result.ttProbes += searcher->GetTtProbes();
+        result.ttHits += searcher->GetTtHits();
+        result.cutoffs += searcher->GetCutoffs();
+        result.firstMoveCutoffs += searcher->GetFirstMoveCutoffs();
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+
+    return result;
+}
+
+
+SearchResult Search(const Position &position, const SearchLimits &limits, const IterationCallback &onIteration) {
+
+    TranspositionTable table(DEFAULT_HASH_MB);
+    return Search(position, limits, table, 1, onIteration);
+}
+
+
+std::string FormatScore(int score) {
+
+    if (std::abs(score) < MATE_BOUND)
+        return "cp " + std::to_string(score);
+
+    // Plies to mate, rounded up to moves
+    int plies = MATE_SCORE - std::abs(score);
+    return "mate " + std::to_string(score > 0 ? (plies + 1) / 2 : -(plies + 1) / 2);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Move.hpp"
+#include "Position.hpp"
+#include "TranspositionTable.hpp"
+
+// Deepest ply the search reaches, quiescence included
+constexpr int MAX_PLY = 64;
+
+// Scores are centipawns from the side to move's point of view. Being mated n plies from the
+// root scores -(MATE_SCORE - n), so every score beyond MATE_BOUND either way is a forced mate
+constexpr int INFINITE_SCORE = 32000;
+constexpr int MATE_SCORE = 31000;
+constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+// Size of the table made by the Search overload that is not given one
+constexpr size_t DEFAULT_HASH_MB = 16;
+
+// When to stop searching. The search stops at whichever limit it reaches first, and a limit of 0 is no limit
+struct SearchLimits {
+    int depth = MAX_PLY;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+};
+
+// The outcome of the deepest completed iteration
+struct SearchResult {
+    // Move::None() if the root has no legal moves
+    Move bestMove = Move::None();
+    int score = 0;
+    int depth = 0;
+
+    // The expected line of play from the root, starting with bestMove
+    std::vector<Move> pv;
+
+    // Nodes searched and time taken by every iteration so far, not just the last
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+
+    // Transposition table lookups and how many found their position, over every iteration,
+    // and the table's fill in permille at the end of the last one
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    int hashfull = 0;
+
+    // Beta cutoffs in the main search, and how many the first move searched gave. The share of
+    // first-move cutoffs measures the move ordering: the closer to 1, the fewer moves are searched
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+
+    uint64_t GetNodesPerSecond() const {return seconds > 0.0 ? static_cast<uint64_t>(nodes / seconds) : 0;}
+    double GetHitRate() const {return ttProbes ? static_cast<double>(ttHits) / ttProbes : 0.0;}
+    double GetFirstMoveCutoffRate() const {return cutoffs ? static_cast<double>(firstMoveCutoffs) / cutoffs : 0.0;}
+};
+
+// Called after every completed iteration, e.g. to print its line of output
+using IterationCallback = std::function<void(const SearchResult &result)>;
+
+// Finds the best move in position by iterative deepening of a negamax alpha-beta search with a
+// quiescence search at the leaves. Only repetitions within the search itself are seen as draws,
+// as a Position carries no game history. table is kept between calls, so that searches of
+// following positions in a game start from what earlier ones found.
+// With more than one thread the search is Lazy SMP: helper threads search the same root
+// alongside the main one, sharing only table, and the main thread's result is returned with
+// the nodes and table probes of every thread
+SearchResult Search(const Position &position, const SearchLimits &limits, TranspositionTable &table,
+                    int threadCount = 1, const IterationCallback &onIteration = nullptr);
+
+// Single-threaded Search with a new table of DEFAULT_HASH_MB, for one-off searches
+SearchResult Search(const Position &position, const SearchLimits &limits, const IterationCallback &onIteration = nullptr);
+
+// score as "cp <centipawns>", or "mate <moves>" with negative moves when the side to move is mated
+std::string FormatScore(int score);
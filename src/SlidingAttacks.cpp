@@ -0,0 +1,171 @@
+#include "SlidingAttacks.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#endif
+
+namespace SlidingAttacks {
+
+    // Found offline for this board layout (a8 = 0, h1 = 63), with shift = 64 - popcount(mask)
+    constexpr std::array<uint64_t, 64> ROOK_MAGICS = {
+        0x0280132180004001ULL, 0x0140001000200040ULL, 0x0880200010000880ULL, 0x2080080005801000ULL,
+        0x0200041020080200ULL, 0x0200041041084200ULL, 0x0400080081124410ULL, 0x2180042100004080ULL,
+        0x8000800099644000ULL, 0x0802003040820100ULL, 0x0105801001862000ULL, 0x0101002008100100ULL,
+        0x1000800400080080ULL, 0x0804800200040080ULL, 0x2001800200800900ULL, 0x00160004088204c1ULL,
+        0x228000c001402000ULL, 0x8510004000200050ULL, 0x3001848020029000ULL, 0x0280808010000801ULL,
+        0x0109010010040800ULL, 0x8000808004000200ULL, 0x8000040081021028ULL, 0x40040a0009004884ULL,
+        0x80c0004280008035ULL, 0x0010004040002000ULL, 0x1101200500410070ULL, 0x8410100080080080ULL,
+        0x000c080080800400ULL, 0x4012008080040002ULL, 0x4000040101000200ULL, 0x0061010200008044ULL,
+        0x0080804010800020ULL, 0x3000201008400040ULL, 0x4112008012002444ULL, 0x0848000880801000ULL,
+        0x00a8008008800400ULL, 0x200200280a00500cULL, 0x080a221024004801ULL, 0xc400008042000104ULL,
+        0x8000400080028022ULL, 0x0220008040018020ULL, 0x4000200011010040ULL, 0x10060040210a0010ULL,
+        0x40820020904a0004ULL, 0x0030040002008080ULL, 0x0200020801840010ULL, 0x0084c04100820004ULL,
+        0x4802010080c2a600ULL, 0x0000400080201880ULL, 0x2040801000200080ULL, 0x0180200842001200ULL,
+        0x0013510008000500ULL, 0x0182000c00808a80ULL, 0x1000524821302400ULL, 0x3800040108488200ULL,
+        0x104a004810210082ULL, 0x0004210010420082ULL, 0xc424110008200241ULL, 0x90101000a0088501ULL,
+        0x0182000420100802ULL, 0x4822001001080402ULL, 0x05d0080090012204ULL, 0x2008140089042846ULL
+    };
+
+    constexpr std::array<uint64_t, 64> BISHOP_MAGICS = {
+        0x0420220228022c80ULL, 0x200208010c108000ULL, 0x1004010411040040ULL, 0x12a4040292002440ULL,
+        0x0804042082000850ULL, 0x0802020220010440ULL, 0x800401048260201aULL, 0x0041010800828800ULL,
+        0x4040641488080104ULL, 0x20002004016e0020ULL, 0x0c2c223a12420042ULL, 0x0100024081020220ULL,
+        0x0383211041025080ULL, 0x08c0030420160600ULL, 0x0c1000510808c00aULL, 0x40501a0084140280ULL,
+        0x40280040112c0088ULL, 0x4020040908110050ULL, 0x1028001008801412ULL, 0x0104220202020000ULL,
+        0x800a000400940010ULL, 0x0401000200512410ULL, 0x1082012100900408ULL, 0x0101402208440c00ULL,
+        0x00482104c01c1111ULL, 0x0310105008017101ULL, 0x0022010108080020ULL, 0x02300400104010a0ULL,
+        0x1401010011444000ULL, 0x1001020000405020ULL, 0x00010a0804480411ULL, 0x0419220010404400ULL,
+        0x0010020a00200820ULL, 0xa008280909040104ULL, 0x0210209010080020ULL, 0x3006110800040040ULL,
+        0x0800820200440090ULL, 0x0008100421810080ULL, 0x0028060093264800ULL, 0x0a08004088810080ULL,
+        0x3611100290442000ULL, 0x0241081282001001ULL, 0x11081108010d0800ULL, 0x002a102014420800ULL,
+        0x480002600a004500ULL, 0x8001010102000100ULL, 0x2008080810410883ULL, 0x0002080901101022ULL,
+        0x2800942420444080ULL, 0x2000840108024000ULL, 0x0000804844100040ULL, 0x1444120020884540ULL,
+        0x0004001002020c00ULL, 0x041041c801010049ULL, 0x0060045000850810ULL, 0x1003240c14820208ULL,
+        0x3010104a10100800ULL, 0x0280020101580200ULL, 0x1000000101081600ULL, 0x0644009800420200ULL,
+        0x0050040008102402ULL, 0x00000004601c8106ULL, 0x00088530040812a0ULL, 0x800218010102020cULL
+    };
+
+    // Sum over all squares of 2^popcount(mask): 102400 rook entries and 5248 bishop entries
+    constexpr int ROOK_TABLE_SIZE = 102400;
+    constexpr int BISHOP_TABLE_SIZE = 5248;
+
+    alignas(64) uint64_t attackTable[ROOK_TABLE_SIZE + BISHOP_TABLE_SIZE];
+
+    std::array<Magic, 64> rookMagics;
+    std::array<Magic, 64> bishopMagics;
+    bool usePext = false;
+
+
+    uint64_t GenerateSlidingAttacks(int squareIdx, uint64_t occupancy, bool isRook) {
+
+        constexpr int rookSteps[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+        constexpr int bishopSteps[4][2] = {{-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+
+        uint64_t attacks = 0ULL;
+
+        for (auto &step : (isRook ? rookSteps : bishopSteps)) {
+
+            int file = squareIdx % 8 + step[0];
+            int row = squareIdx / 8 + step[1];
+
+            while (file >= 0 && file < 8 && row >= 0 && row < 8) {
+
+                attacks |= (1ULL << (file + row * 8));
+
+                // The blocker itself is attacked, but nothing behind it
+                if (occupancy & (1ULL << (file + row * 8)))
+                    break;
+
+                file += step[0];
+                row += step[1];
+            }
+        }
+
+        return attacks;
+    }
+
+
+    // Fills one piece type's magics and table slices, starting at tableStart
+    static uint64_t *InitPiece(std::array<Magic, 64> &magics, const std::array<uint64_t, 64> &magicNumbers,
+                               uint64_t *tableStart, bool isRook)
+    {
+        for (int squareIdx = 0; squareIdx < 64; squareIdx++) {
+
+            Magic &entry = magics[squareIdx];
+            entry.mask = isRook ? GenerateRookMask(squareIdx) : GenerateBishopMask(squareIdx);
+            entry.magic = magicNumbers[squareIdx];
+            entry.shift = 64 - __builtin_popcountll(entry.mask);
+            entry.attacks = tableStart;
+
+            // Enumerate every subset of the mask (Carry-Rippler) and store its attack set
+            uint64_t subset = 0ULL;
+            do {
+                uint64_t tableIdx = usePext ? Pext(subset, entry.mask) : ((subset * entry.magic) >> entry.shift);
+                tableStart[tableIdx] = GenerateSlidingAttacks(squareIdx, subset, isRook);
+                subset = (subset - entry.mask) & entry.mask;
+            } while (subset);
+
+            tableStart += 1ULL << (64 - entry.shift);
+        }
+
+        return tableStart;
+    }
+
+
+    bool HasBmi2() {
+
+#if defined(__x86_64__) && defined(__GNUC__)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+        // Leaf 7, sub-leaf 0: EBX bit 8 is BMI2
+        return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1U << 8));
+#else
+        return false;
+#endif
+    }
+
+
+    bool HasFastPext() {
+
+        if (!HasBmi2())
+            return false;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+        // AMD before Zen 3 (family 0x19) implements PEXT in microcode, far slower than a multiply
+        __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+        bool isAmd = (ebx == 0x68747541);  // "Auth", from "AuthenticAMD"
+
+        __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+        int family = ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF);
+
+        return !isAmd || family >= 0x19;
+#else
+        return false;
+#endif
+    }
+
+
+    void SetBackend(Backend backend) {
+
+        usePext = (backend == Backend::PEXT);
+
+        uint64_t *next = InitPiece(rookMagics, ROOK_MAGICS, attackTable, true);
+        InitPiece(bishopMagics, BISHOP_MAGICS, next, false);
+    }
+
+
+    Backend GetBackend() {
+        return usePext ? Backend::PEXT : Backend::MAGIC;
+    }
+
+
+    void Init() {
+        SetBackend(HasFastPext() ? Backend::PEXT : Backend::MAGIC);
+    }
+
+
+    // The tables are ready before main runs, so no caller has to remember to initialise them
+    static const bool isInitialised = (Init(), true);
+}
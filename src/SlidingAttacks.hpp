@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "LookupTables.hpp"
+
+// Blocker-aware rook and bishop attacks. For each square, the relevant blockers are
+// turned into an index into that square's slice of one shared attack table, either by
+// a magic multiply and shift or, on CPUs with BMI2, by a single PEXT instruction.
+namespace SlidingAttacks {
+
+    enum class Backend {MAGIC, PEXT};
+
+    struct Magic {
+        // The piece's rays from this square, minus the last square of each ray
+        uint64_t mask;
+        uint64_t magic;
+
+        // This square's slice of the shared attack table
+        const uint64_t *attacks;
+        int shift;
+    };
+
+    extern std::array<Magic, 64> rookMagics;
+    extern std::array<Magic, 64> bishopMagics;
+
+    // Relevant occupancy masks. Blockers on the edge of the board never change the attack set
+    constexpr uint64_t GenerateRookMask(int squareIdx) {
+
+        using namespace LookupTables;
+        uint64_t fileRays = GenerateRay(squareIdx, 0, -1) | GenerateRay(squareIdx, 0, 1);
+        uint64_t rankRays = GenerateRay(squareIdx, -1, 0) | GenerateRay(squareIdx, 1, 0);
+
+        return (fileRays & ~(Rank1 | Rank8)) | (rankRays & ~(AFile | HFile));
+    }
+
+    constexpr uint64_t GenerateBishopMask(int squareIdx) {
+        return LookupTables::bishopLookupTable[squareIdx] & ~LookupTables::OuterEdge;
+    }
+
+    // Set once by SetBackend. The branch on it is taken the same way on every call
+    extern bool usePext;
+
+    // Gathers the bits of source selected by mask into the low bits of the result
+    inline uint64_t Pext(uint64_t source, uint64_t mask) {
+#if defined(__x86_64__) && defined(__GNUC__)
+        uint64_t result;
+        asm("pextq %2, %1, %0" : "=r"(result) : "r"(source), "r"(mask));
+        return result;
+#else
+        uint64_t result = 0ULL;
+        for (uint64_t bit = 1ULL; mask; bit <<= 1, mask &= mask - 1) {
+            if (source & mask & -mask)
+                result |= bit;
+        }
+        return result;
+#endif
+    }
+
+    inline uint64_t GetAttacks(const Magic &entry, uint64_t occupancy) {
+
+        if (usePext)
+            return entry.attacks[Pext(occupancy, entry.mask)];
+
+        return entry.attacks[((occupancy & entry.mask) * entry.magic) >> entry.shift];
+    }
+
+    inline uint64_t GetRookAttacks(int idx, uint64_t occupancy) {
+        return GetAttacks(rookMagics[idx], occupancy);
+    }
+
+    inline uint64_t GetBishopAttacks(int idx, uint64_t occupancy) {
+        return GetAttacks(bishopMagics[idx], occupancy);
+    }
+
+    inline uint64_t GetQueenAttacks(int idx, uint64_t occupancy) {
+        return GetRookAttacks(idx, occupancy) | GetBishopAttacks(idx, occupancy);
+    }
+
+    // Walks each ray square by square, stopping at the first blocker. Only used to fill the table
+    uint64_t GenerateSlidingAttacks(int squareIdx, uint64_t occupancy, bool isRook);
+
+    // True if the CPU supports the PEXT instruction at all
+    bool HasBmi2();
+
+    // True if the CPU has BMI2 and implements PEXT in hardware rather than microcode
+    bool HasFastPext();
+
+    // Refills the shared attack table in the layout the backend indexes. Not thread safe:
+    // only call it before any other thread is reading attacks
+    void SetBackend(Backend backend);
+    Backend GetBackend();
+
+    // Picks PEXT if HasFastPext() and magics otherwise. Called once during static initialisation
+    void Init();
+}
@@ -0,0 +1,282 @@
+#include "StaticExchange.hpp"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include "Evaluation.hpp"
+#include "MoveGeneration.hpp"
+#include "Perft.hpp"
+#include "SlidingAttacks.hpp"
+
+namespace StaticExchange {
+
+    // Evaluation::pieceValues, but with a king worth more than everything else together, so that
+    // the king never takes on a square the other side can still take back on
+    constexpr std::array<int, 6> exchangeValues = {Evaluation::pieceValues[PAWN], Evaluation::pieceValues[ROOK],
+                                                   Evaluation::pieceValues[KNIGHT], Evaluation::pieceValues[BISHOP],
+                                                   Evaluation::pieceValues[QUEEN], 20000};
+
+    // Each side takes with its cheapest attacker first
+    constexpr std::array<PieceType, 6> cheapestFirst = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+
+    // What the first capture takes and leaves on the square, and the occupancy after it
+    struct FirstCapture {
+        int capturedValue;
+        int movedValue;
+        uint64_t occupancy;
+    };
+
+
+    static FirstCapture MakeFirstCapture(const Position &position, Move move) {
+
+        int from = move.GetFrom();
+        int to = move.GetTo();
+        int captured = position.GetPieceOn(to);
+
+        FirstCapture capture;
+        capture.capturedValue = (captured == NO_PIECE) ? 0 : exchangeValues[captured % 6];
+        capture.movedValue = exchangeValues[position.GetPieceOn(from) % 6];
+        capture.occupancy = position.GetAllPieces() & ~(1ULL << from);
+
+        // The pawn taken en passant is beside the to square, not on it
+        if (move.GetFlag() == Move::EN_PASSANT) {
+            capture.capturedValue = exchangeValues[PAWN];
+            capture.occupancy &= ~(1ULL << (to + (position.GetActiveColour() == WHITE ? 8 : -8)));
+        }
+
+        // The pawn turns into the promoted piece, which is what the other side can take back
+        if (move.GetFlag() == Move::PROMOTION) {
+            capture.capturedValue += exchangeValues[move.GetPromotion()] - exchangeValues[PAWN];
+            capture.movedValue = exchangeValues[move.GetPromotion()];
+        }
+
+        return capture;
+    }
+
+
+    // The cheapest of sideAttackers: sets type and returns its square's bit
+    static uint64_t GetCheapestAttacker(const Position &position, uint64_t sideAttackers, PieceType &type) {
+
+        for (PieceType candidate : cheapestFirst) {
+            uint64_t attackers = sideAttackers & position.GetPieces(candidate);
+            if (attackers) {
+                type = candidate;
+                return attackers & -attackers;
+            }
+        }
+
+        return 0ULL;
+    }
+
+
+    // attackers, with the sliders behind a piece of type that has just left occupancy added. Only
+    // a piece that moves along a line can have been in the way of a slider attacking the square
+    static uint64_t AddXrays(const Position &position, int squareIdx, uint64_t occupancy, uint64_t attackers, PieceType type) {
+
+        uint64_t queens = position.GetPieces(QUEEN);
+
+        if (type == PAWN || type == BISHOP || type == QUEEN)
+            attackers |= SlidingAttacks::GetBishopAttacks(squareIdx, occupancy) & (position.GetPieces(BISHOP) | queens);
+        if (type == ROOK || type == QUEEN)
+            attackers |= SlidingAttacks::GetRookAttacks(squareIdx, occupancy) & (position.GetPieces(ROOK) | queens);
+
+        return attackers & occupancy;
+    }
+
+
+    int Evaluate(const Position &position, Move move) {
+
+        if (move.GetFlag() == Move::CASTLING)
+            return 0;
+
+        int to = move.GetTo();
+        FirstCapture capture = MakeFirstCapture(position, move);
+        uint64_t occupancy = capture.occupancy;
+        uint64_t attackers = position.GetAttackersTo(to, occupancy) & occupancy;
+        Colour side = (position.GetActiveColour() == WHITE) ? BLACK : WHITE;
+
+        // gains[n] is what the side making the nth capture has won if the exchange stops there.
+        // There are at most 32 pieces, so at most 32 captures
+        std::array<int, 33> gains;
+        gains[0] = capture.capturedValue;
+        int onSquare = capture.movedValue;
+        int captureCount = 0;
+
+        while (true) {
+
+            PieceType type;
+            uint64_t attacker = GetCheapestAttacker(position, attackers & position.GetColourPieces(side), type);
+            if (!attacker)
+                break;
+
+            captureCount++;
+            gains[captureCount] = onSquare - gains[captureCount - 1];
+            onSquare = exchangeValues[type];
+
+            occupancy ^= attacker;
+            attackers = AddXrays(position, to, occupancy, attackers, type);
+            side = (side == WHITE) ? BLACK : WHITE;
+        }
+
+        // Working back from the end, each side either takes or stops, whichever leaves it better off
+        for (int n = captureCount; n > 0; n--)
+            gains[n - 1] = -std::max(-gains[n - 1], gains[n]);
+
+        return gains[0];
+    }
+
+
+    bool IsAtLeast(const Position &position, Move move, int threshold) {
+
+        if (move.GetFlag() == Move::CASTLING)
+            return threshold <= 0;
+
+        int to = move.GetTo();
+        FirstCapture capture = MakeFirstCapture(position, move);
+
+        // swap is how far above the threshold the side to move would end up if the exchange
+        // stopped after the other side's next capture. Stopping straight away falls short
+        int swap = capture.capturedValue - threshold;
+        if (swap < 0)
+            return false;
+
+        // Losing the moved piece still clears the threshold
+        swap = capture.movedValue - swap;
+        if (swap <= 0)
+            return true;
+
+        uint64_t occupancy = capture.occupancy;
+        uint64_t attackers = position.GetAttackersTo(to, occupancy) & occupancy;
+        Colour side = position.GetActiveColour();
+
+        // Whether the threshold is met if the side that just captured has the last word
+        bool result = true;
+
+        while (true) {
+
+            side = (side == WHITE) ? BLACK : WHITE;
+
+            PieceType type;
+            uint64_t attacker = GetCheapestAttacker(position, attackers & position.GetColourPieces(side), type);
+            if (!attacker)
+                break;
+
+            result = !result;
+
+            // The king can only take last, when the other side has nothing left to take back with
+            if (type == KING)
+                return (attackers & ~position.GetColourPieces(side)) ? !result : result;
+
+            swap = exchangeValues[type] - swap;
+            if (swap < static_cast<int>(result))
+                break;
+
+            occupancy ^= attacker;
+            attackers = AddXrays(position, to, occupancy, attackers, type);
+        }
+
+        return result;
+    }
+
+
+    const std::vector<TestCase> &GetTestCases() {
+
+        static const std::vector<TestCase> testCases = {
+            {"undefended pawn", "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100},
+            {"x-rays behind both sides", "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -220},
+            {"rook takes a defended pawn", "4k3/8/3p4/4p3/8/8/8/4RK2 w - - 0 1", "e1e5", -400},
+            {"knight takes a defended pawn", "4k3/8/2p5/3p4/8/4N3/8/4K3 w - - 0 1", "e3d5", -220},
+            {"doubled rooks", "4k3/4r3/8/4p3/8/8/4R3/4R1K1 w - - 0 1", "e2e5", 100},
+            {"queen behind bishop", "4k3/8/2b5/3p4/8/5B2/6Q1/4K3 w - - 0 1", "f3d5", 100},
+            {"king cannot take back", "8/8/4k3/3p4/8/8/3R4/3QK3 w - - 0 1", "d2d5", 100},
+            {"king takes back", "8/8/4k3/3p4/8/8/3R4/4K3 w - - 0 1", "d2d5", -400},
+            {"en passant", "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100},
+            {"promotion", "4k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7a8q", 800},
+            {"capturing promotion taken back", "1r2k3/P2n4/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 400},
+            {"black queen takes a rook the king defends", "4k3/8/8/3q4/8/8/8/3RK3 b - - 0 1", "d5d1", -400},
+        };
+
+        return testCases;
+    }
+
+
+    // Checks IsAtLeast against Evaluate for every capture within depth plies of position,
+    // returning the number of captures checked and adding any disagreements to failures
+    static uint64_t CheckAgreement(Position &position, int depth, uint64_t &failures) {
+
+        MoveList moves;
+        MoveGeneration::GenerateLegalMoves(position, moves);
+        uint64_t checked = 0;
+
+        for (Move move : moves) {
+
+            if (MoveGeneration::IsCapture(position, move)) {
+
+                int value = Evaluate(position, move);
+                checked++;
+
+                for (int threshold : {value - 1, value, value + 1, 0, -100, 100}) {
+                    if (IsAtLeast(position, move, threshold) != (value >= threshold)) {
+                        failures++;
+                        std::cout << "mismatch: " << position.ToFen() << " " << move.ToString() << ", value " << value
+                                  << ", threshold " << threshold << std::endl;
+                    }
+                }
+            }
+
+            if (depth > 1) {
+                UndoInfo undo = position.MakeMove(move);
+                checked += CheckAgreement(position, depth - 1, failures);
+                position.UnmakeMove(move, undo);
+            }
+        }
+
+        return checked;
+    }
+
+
+    bool RunSuite() {
+
+        int failedCases = 0;
+
+        for (const TestCase &test : GetTestCases()) {
+
+            Position position;
+            position.SetFromFen(test.fen);
+
+            MoveList moves;
+            MoveGeneration::GenerateLegalMoves(position, moves);
+            auto found = std::find_if(moves.begin(), moves.end(), [&test](Move move) {return move.ToString() == test.move;});
+
+            if (found == moves.end()) {
+                std::cout << test.name << ": " << test.move << " is not legal" << std::endl;
+                failedCases++;
+                continue;
+            }
+
+            int value = Evaluate(position, *found);
+            bool isThresholdRight = IsAtLeast(position, *found, test.value) && !IsAtLeast(position, *found, test.value + 1);
+            bool isPassed = (value == test.value) && isThresholdRight;
+            failedCases += !isPassed;
+
+            std::cout << test.name << ": " << test.move << " " << value << (isPassed ? " OK" : " FAIL")
+                      << " (expected " << test.value << (isThresholdRight ? "" : ", threshold form disagrees") << ")" << std::endl;
+        }
+
+        uint64_t failures = 0;
+        uint64_t checked = 0;
+
+        for (const Perft::TestPosition &test : Perft::GetTestPositions()) {
+            Position position;
+            position.SetFromFen(test.fen);
+            checked += CheckAgreement(position, 3, failures);
+        }
+
+        std::cout << "threshold form: " << checked << " captures, " << failures << " disagreements with the exact form" << std::endl;
+
+        bool isPassed = (failedCases == 0 && failures == 0);
+        std::cout << (isPassed ? "All exchanges match" : "Some exchanges differ") << std::endl;
+
+        return isPassed;
+    }
+}
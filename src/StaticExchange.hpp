@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Move.hpp"
+#include "Position.hpp"
+
+// Static exchange evaluation: the material a move wins or loses once every capture on its to
+// square has been played out, each side capturing with its least valuable piece and free to stop
+// when going on would lose more. Attackers come from Position::GetAttackersTo, and sliders
+// uncovered behind a piece that has just captured (x-rays) join in. Pins are not considered,
+// and a pawn capturing onto the last rank counts as a pawn
+namespace StaticExchange {
+
+    // The exchange's value to the side making move, in Evaluation::pieceValues. Promotions
+    // count what the pawn turns into, and castling is worth 0
+    int Evaluate(const Position &position, Move move);
+
+    // Whether Evaluate(position, move) >= threshold, which is all pruning and ordering need to
+    // know. Cheaper than Evaluate, as it stops as soon as the answer is certain
+    bool IsAtLeast(const Position &position, Move move, int threshold);
+
+    // A position and a move in it whose exchange value is known
+    struct TestCase {
+        std::string name;
+        std::string fen;
+        std::string move;
+        int value;
+    };
+
+    // Hand-checked exchanges: undefended and defended captures, x-rays on files and diagonals,
+    // kings that may not recapture, en passant and promotions
+    const std::vector<TestCase> &GetTestCases();
+
+    // Checks both forms against every test case, then checks that IsAtLeast agrees with
+    // Evaluate at and around the exact value for every capture within three plies of the perft
+    // test positions, printing the results. Returns true if everything matches
+    bool RunSuite();
+}
@@ -0,0 +1,111 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(int threadCount) :
+    nextQueue(0), queuedTasks(0), unfinishedTasks(0), isStopping(false)
+{
+    if (threadCount < 1)
+        threadCount = 1;
+
+    for (int i = 0; i < threadCount; i++)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    for (int i = 0; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+
+ThreadPool::~ThreadPool() {
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        isStopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+
+void ThreadPool::Submit(std::function<void()> task) {
+
+    WorkQueue &queue = *queues[nextQueue];
+    nextQueue = (nextQueue + 1) % queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    // Counted under sleepMutex so a worker cannot check for work and go to sleep in between
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        unfinishedTasks++;
+        queuedTasks++;
+    }
+    taskAvailable.notify_one();
+}
+
+
+void ThreadPool::Wait() {
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allTasksDone.wait(lock, [this] {return unfinishedTasks == 0;});
+}
+
+
+bool ThreadPool::TryTakeTask(int workerIdx, std::function<void()> &task) {
+
+    int queueCount = static_cast<int>(queues.size());
+
+    for (int offset = 0; offset < queueCount; offset++) {
+
+        WorkQueue &queue = *queues[(workerIdx + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+            continue;
+
+        // The owner works depth-first from the back; thieves take the oldest task from the front
+        if (offset == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        queuedTasks--;
+        return true;
+    }
+
+    return false;
+}
+
+
+void ThreadPool::WorkerLoop(int workerIdx) {
+
+    std::function<void()> task;
+
+    while (true) {
+
+        if (TryTakeTask(workerIdx, task)) {
+
+            task();
+            task = nullptr;
+
+            if (--unfinishedTasks == 0) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                allTasksDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        taskAvailable.wait(lock, [this] {return isStopping || queuedTasks > 0;});
+
+        if (isStopping && queuedTasks == 0)
+            return;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads, each with its own task queue. Workers take tasks from the
+// back of their own queue and, when it is empty, steal from the front of the others'
+class ThreadPool {
+
+    public:
+        explicit ThreadPool(int threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Queues task, spreading tasks round-robin over the workers' queues
+        void Submit(std::function<void()> task);
+
+        // Blocks until every submitted task has finished
+        void Wait();
+
+        int GetThreadCount() const {return static_cast<int>(workers.size());}
+
+    private:
+        void WorkerLoop(int workerIdx);
+
+        // Pops from the back of the worker's own queue, else steals from the front of another
+        bool TryTakeTask(int workerIdx, std::function<void()> &task);
+
+    private:
+        // Padded so that two workers' queues never share a cache line
+        struct alignas(64) WorkQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        int nextQueue;
+
+        // Tasks submitted but not yet taken, and submitted but not yet finished
+        std::atomic<int> queuedTasks;
+        std::atomic<int> unfinishedTasks;
+        bool isStopping;
+
+        // Guards sleeping and waking, both of workers and of Wait()
+        std::mutex sleepMutex;
+        std::condition_variable taskAvailable;
+        std::condition_variable allTasksDone;
+};
@@ -0,0 +1,113 @@
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <climits>
+
+TranspositionTable::TranspositionTable(size_t sizeMB) : generation(0) {
+
+    clusterCount = 1;
+    while (clusterCount * 2 * sizeof(Cluster) <= sizeMB * 1024 * 1024)
+        clusterCount *= 2;
+
+    clusters.reset(new Cluster[clusterCount]);
+    Clear();
+}
+
+
+void TranspositionTable::Clear() {
+
+    // A zero entry decodes as BOUND_NONE, which is never stored, so it can never produce a hit
+    for (size_t i = 0; i < clusterCount; i++) {
+        for (VerifiedEntry &entry : clusters[i].entries)
+            entry.Clear();
+    }
+
+    generation = 0;
+}
+
+
+uint64_t TranspositionTable::Pack(Move move, int score, int eval, int depth, Bound bound, int generation) {
+
+    return static_cast<uint64_t>(move.GetData())
+         | static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16
+         | static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32
+         | static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48
+         | static_cast<uint64_t>(bound) << 56
+         | static_cast<uint64_t>(generation) << 58;
+}
+
+
+TranspositionTable::Data TranspositionTable::Unpack(uint64_t data) {
+
+    return {Move::FromData(static_cast<uint16_t>(data)),
+            static_cast<int16_t>(data >> 16),
+            static_cast<int16_t>(data >> 32),
+            static_cast<uint8_t>(data >> 48),
+            static_cast<Bound>((data >> 56) & 3)};
+}
+
+
+bool TranspositionTable::Probe(uint64_t key, Data &data) const {
+
+    for (const VerifiedEntry &entry : GetCluster(key).entries) {
+
+        uint64_t entryData;
+        if (entry.Load(key, entryData) && ((entryData >> 56) & 3) != BOUND_NONE) {
+            data = Unpack(entryData);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void TranspositionTable::Store(uint64_t key, Move move, int score, int eval, int depth, Bound bound) {
+
+    Cluster &cluster = GetCluster(key);
+    VerifiedEntry *target = nullptr;
+    int lowestWorth = 0;
+
+    for (VerifiedEntry &entry : cluster.entries) {
+
+        // An entry for the same position is overwritten, keeping its move if there is no new one,
+        // unless it comes from a much deeper search and the new score is only a bound
+        uint64_t entryData;
+        if (entry.Load(key, entryData)) {
+            Data stored = Unpack(entryData);
+            if (bound != BOUND_EXACT && stored.depth > depth + 4 && GetGeneration(entryData) == generation)
+                return;
+            if (move.IsNone())
+                move = stored.move;
+            target = &entry;
+            break;
+        }
+
+        // Otherwise an empty entry is taken, or else the shallowest, with each search's worth of age counting as 8 plies
+        int age = (generation - GetGeneration(entryData)) & GENERATION_MASK;
+        int worth = (((entryData >> 56) & 3) == BOUND_NONE) ? INT_MIN : Unpack(entryData).depth - 8 * age;
+
+        if (!target || worth < lowestWorth) {
+            target = &entry;
+            lowestWorth = worth;
+        }
+    }
+
+    uint64_t data = Pack(move, score, eval, depth, bound, generation);
+    target->Store(key, data);
+}
+
+
+int TranspositionTable::GetHashfull() const {
+
+    size_t sampleClusters = std::min<size_t>(clusterCount, 250);
+    int used = 0;
+
+    for (size_t i = 0; i < sampleClusters; i++) {
+        for (const VerifiedEntry &entry : clusters[i].entries) {
+            uint64_t entryData = entry.LoadData();
+            used += ((entryData >> 56) & 3) != BOUND_NONE && GetGeneration(entryData) == generation;
+        }
+    }
+
+    return static_cast<int>(used * 1000 / (sampleClusters * CLUSTER_SIZE));
+}
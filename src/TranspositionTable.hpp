@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "Move.hpp"
+#include "VerifiedEntry.hpp"
+
+// Remembers what the search found in each position, so transposed positions are not searched
+// again and the best move found last time is tried first. It is shared by every search thread
+// without locks, through VerifiedEntry like PerftTable
+class TranspositionTable {
+
+    public:
+        // What the stored score says about the position's real score
+        enum Bound : uint8_t {BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT};
+
+        // Stored in place of a static evaluation that was never worked out
+        static constexpr int NO_EVAL = INT16_MIN;
+
+        // One entry's contents, unpacked
+        struct Data {
+            Move move;
+            int score;
+            int eval;
+            int depth;
+            Bound bound;
+        };
+
+        // Allocates the largest power-of-two number of clusters that fits in sizeMB
+        explicit TranspositionTable(size_t sizeMB);
+
+        // Empties every entry
+        void Clear();
+
+        // Marks the start of a new search, so entries from earlier searches are replaced first
+        void NewSearch() {generation = (generation + 1) & GENERATION_MASK;}
+
+        // Returns true and sets data if key is stored
+        bool Probe(uint64_t key, Data &data) const;
+
+        // Stores an entry for key. score must fit in 16 bits and depth in 8. A move of
+        // Move::None() keeps the move already stored for key, if there is one
+        void Store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+
+        // Starts loading key's cluster into the cache, ahead of a Probe for it
+        void Prefetch(uint64_t key) const {__builtin_prefetch(&GetCluster(key));}
+
+        // How full the table is with entries from the current search, in permille, from a sample of clusters
+        int GetHashfull() const;
+
+        size_t GetSizeBytes() const {return clusterCount * sizeof(Cluster);}
+
+    private:
+        // Four entries to a cache line, so a probe touches one line. Each entry's data packs, from
+        // the low bits up, the move (16 bits), score (16), eval (16), depth (8), bound (2) and generation (6)
+        static constexpr int CLUSTER_SIZE = 4;
+
+        struct alignas(64) Cluster {
+            VerifiedEntry entries[CLUSTER_SIZE];
+        };
+
+        static_assert(sizeof(Cluster) == 64, "A cluster should fill exactly one cache line");
+
+        static constexpr int GENERATION_MASK = 63;
+
+        Cluster &GetCluster(uint64_t key) const {return clusters[key & (clusterCount - 1)];}
+
+        static uint64_t Pack(Move move, int score, int eval, int depth, Bound bound, int generation);
+        static Data Unpack(uint64_t data);
+        static int GetGeneration(uint64_t data) {return static_cast<int>(data >> 58);}
+
+    private:
+        std::unique_ptr<Cluster[]> clusters;
+        size_t clusterCount;
+        int generation;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// A hash table entry that threads can share without locks. It stores key ^ data next to data,
+// so an entry torn by two threads writing at once fails the key check and reads as a miss.
+// Used by PerftTable and TranspositionTable, which each decide what data packs
+struct VerifiedEntry {
+    std::atomic<uint64_t> keyXorData;
+    std::atomic<uint64_t> data;
+
+    // Sets entryData to the stored data and returns whether it was stored for key. The full key
+    // is checked, so only a real 64-bit key collision can give another position's data
+    bool Load(uint64_t key, uint64_t &entryData) const {
+        entryData = data.load(std::memory_order_relaxed);
+        return (keyXorData.load(std::memory_order_relaxed) ^ entryData) == key;
+    }
+
+    // The stored data whatever its key, for choosing which entry to replace
+    uint64_t LoadData() const {return data.load(std::memory_order_relaxed);}
+
+    void Store(uint64_t key, uint64_t entryData) {
+        keyXorData.store(key ^ entryData, std::memory_order_relaxed);
+        data.store(entryData, std::memory_order_relaxed);
+    }
+
+    // An all-zero entry, which each table makes sure never reads as a hit
+    void Clear() {Store(0, 0);}
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Random 64-bit keys XORed together to identify a position: one per piece per square,
+// one for black to move, one per castling rights combination and one per en passant file.
+// They are built at compile time from a fixed seed, so keys are the same on every run
+namespace Zobrist {
+
+    // SplitMix64, a small generator with good enough statistics for hashing
+    constexpr uint64_t NextRandom(uint64_t &state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    struct Keys {
+        std::array<std::array<uint64_t, 64>, 12> pieces;
+        std::array<uint64_t, 16> castling;
+        std::array<uint64_t, 8> enPassantFile;
+        uint64_t blackToMove;
+    };
+
+    constexpr Keys GenerateKeys() {
+
+        Keys keys {};
+        uint64_t state = 0x5EEDC0FFEE15BADULL;
+
+        for (auto &pieceKeys : keys.pieces)
+            for (auto &key : pieceKeys)
+                key = NextRandom(state);
+
+        // No rights hashes to 0, so positions without castling need no special case
+        for (size_t i = 1; i < keys.castling.size(); i++)
+            keys.castling[i] = NextRandom(state);
+
+        for (auto &key : keys.enPassantFile)
+            key = NextRandom(state);
+
+        keys.blackToMove = NextRandom(state);
+
+        return keys;
+    }
+
+    alignas(64) inline constexpr Keys keys = GenerateKeys();
+}
@@ -1,10 +1,231 @@
+#include <charconv>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#ifndef HEADLESS
 #include "Game.hpp"
+#endif
+#include "Benchmark.hpp"
+#include "Perft.hpp"
+#include "Search.hpp"
+#include "StaticExchange.hpp"
+
+// Joins words[first] onwards with spaces, so a FEN can be given with or without quotes
+static std::string JoinWords(const std::vector<std::string> &words, size_t first) {
+
+    std::string joined;
+
+    for (size_t i = first; i < words.size(); i++) {
+        if (i > first)
+            joined += ' ';
+        joined += words[i];
+    }
+
+    return joined;
+}
+
+
+// Reads a whole number from min to max, with nothing before or after it. std::atoi would turn a
+// typo into 0 and let a negative value through, to wrap around as a node limit or a table size
+static bool ParseNumber(const std::string &text, int64_t min, int64_t max, int64_t &value) {
+
+    const char *end = text.data() + text.size();
+    auto [parsedEnd, error] = std::from_chars(text.data(), end, value);
+
+    return error == std::errc() && parsedEnd == end && value >= min && value <= max;
+}
+
+
+// A perft or search depth, from 1 to MAX_PLY
+static bool ParseDepth(const std::string &text, int &depth) {
+
+    int64_t value;
+    if (!ParseNumber(text, 1, MAX_PLY, value))
+        return false;
+
+    depth = static_cast<int>(value);
+    return true;
+}
+
+
+// The range each "--name value" option is checked against. A hash of 0 runs perft without a table
+static const std::map<std::string, std::pair<int64_t, int64_t>> optionRanges = {
+    {"threads", {1, 1024}},
+    {"split", {1, MAX_PLY}},
+    {"hash", {0, 65536}},
+    {"depth", {1, MAX_PLY}},
+    {"nodes", {1, INT64_MAX}},
+    {"movetime", {1, INT64_MAX}},
+};
+
+
+static int PrintUsage() {
+
+    std::cerr << "Usage: main bench <name>\n"
+              << "       main perft <depth> [--threads n] [--split depth] [--hash MB] [fen]\n"
+              << "       main perftscale <depth> [--threads max] [--split depth] [fen]\n"
+              << "       main divide <depth> [fen]\n"
+              << "       main perftsuite [max depth]\n"
+              << "       main seesuite\n"
+              << "       main search [--depth n] [--nodes n] [--movetime ms] [--hash MB] [--threads n] [fen]\n"
+              << "       main searchscale <depth> [--threads max] [--hash MB]\n"
+              << "       main epdload <file> [--threads max]\n"
+              << "       main pack <epd file> <output file> [--threads n]\n"
+              << "Depths are whole numbers from 1 to " << MAX_PLY << ", as are --depth and --split.\n"
+              << "--threads is from 1 to 1024, --hash from 0 to 65536 MB, and --nodes and --movetime at least 1" << std::endl;
+    return 1;
+}
+
+
+// Runs a headless command, which never opens a window, and returns the exit code
+static int RunCommand(int argc, char** args) {
+
+    // Split "--name value" options from the positional words, checking each option's value
+    std::vector<std::string> words;
+    std::map<std::string, int64_t> options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = args[i];
+
+        if (arg.rfind("--", 0) == 0 && i + 1 < argc) {
+            std::string value = args[++i];
+            auto range = optionRanges.find(arg.substr(2));
+
+            if (range == optionRanges.end() || !ParseNumber(value, range->second.first, range->second.second, options[range->first])) {
+                std::cerr << "Invalid option: " << arg << " " << value << std::endl;
+                return PrintUsage();
+            }
+        }
+
+        else
+            words.push_back(arg);
+    }
+
+    auto GetOption = [&options](const std::string &name, int64_t defaultValue) {
+        auto option = options.find(name);
+        return (option != options.end()) ? option->second : defaultValue;
+    };
+
+    std::string command = words.empty() ? "" : words[0];
+    int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    if (command == "bench" && words.size() > 1) {
+
+        if (!Benchmark::Run(words[1])) {
+            std::cerr << "Unknown benchmark: " << words[1] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if ((command == "perft" || command == "divide" || command == "perftscale") && words.size() > 1) {
+
+        int depth;
+        if (!ParseDepth(words[1], depth))
+            return PrintUsage();
+
+        Position position;
+
+        if (words.size() > 2) {
+            FenError error = position.ParseFen(JoinWords(words, 2));
+            if (error != FenError::NONE) {
+                std::cerr << "Invalid FEN (" << Position::GetFenErrorName(error) << "): " << JoinWords(words, 2) << std::endl;
+                return 1;
+            }
+        }
+
+        if (command == "perft")
+            Perft::Run(position, depth, GetOption("threads", 1), GetOption("split", 2), GetOption("hash", 0));
+        else if (command == "divide")
+            Perft::Divide(position, depth);
+        else
+            return Perft::RunScaling(position, depth, GetOption("threads", maxThreads), GetOption("split", 2)) ? 0 : 1;
+        return 0;
+    }
+
+    if (command == "seesuite")
+        return StaticExchange::RunSuite() ? 0 : 1;
+
+    if (command == "search") {
+
+        Position position;
+
+        if (words.size() > 1) {
+            FenError error = position.ParseFen(JoinWords(words, 1));
+            if (error != FenError::NONE) {
+                std::cerr << "Invalid FEN (" << Position::GetFenErrorName(error) << "): " << JoinWords(words, 1) << std::endl;
+                return 1;
+            }
+        }
+
+        SearchLimits limits;
+        limits.depth = GetOption("depth", 0);
+        limits.nodes = GetOption("nodes", 0);
+        limits.timeMs = GetOption("movetime", 0);
+
+        // With no limit at all, search to a depth that finishes quickly
+        if (!limits.depth && !limits.nodes && !limits.timeMs)
+            limits.depth = 6;
+
+        auto PrintLine = [](const SearchResult &result) {
+            std::cout << "depth " << result.depth << " score " << FormatScore(result.score) << " nodes " << result.nodes
+                      << " nps " << result.GetNodesPerSecond() << " hashfull " << result.hashfull
+                      << " time " << static_cast<int64_t>(result.seconds * 1000.0) << " pv";
+            for (Move move : result.pv)
+                std::cout << " " << move.ToString();
+            std::cout << std::endl;
+        };
+
+        TranspositionTable table(GetOption("hash", DEFAULT_HASH_MB));
+        SearchResult result = Search(position, limits, table, GetOption("threads", 1), PrintLine);
+
+        std::cout << "bestmove " << (result.bestMove.IsNone() ? "(none)" : result.bestMove.ToString())
+                  << " (" << result.nodes << " nodes in " << result.seconds << " s, " << result.GetNodesPerSecond() << " nodes/sec)" << std::endl
+                  << "hash: " << table.GetSizeBytes() / (1024 * 1024) << " MB, " << result.ttHits << " hits in "
+                  << result.ttProbes << " probes (" << 100.0 * result.GetHitRate() << "%), hashfull " << result.hashfull << std::endl
+                  << "ordering: " << result.firstMoveCutoffs << " of " << result.cutoffs << " cutoffs on the first move ("
+                  << 100.0 * result.GetFirstMoveCutoffRate() << "%)" << std::endl;
+        return 0;
+    }
+
+    if (command == "searchscale" && words.size() > 1) {
+        int depth;
+        if (!ParseDepth(words[1], depth))
+            return PrintUsage();
+        return Benchmark::SearchScaling(depth, GetOption("threads", 32), GetOption("hash", DEFAULT_HASH_MB)) ? 0 : 1;
+    }
+
+    if (command == "epdload" && words.size() > 1)
+        return Benchmark::EpdLoading(JoinWords(words, 1), GetOption("threads", maxThreads)) ? 0 : 1;
+
+    if (command == "pack" && words.size() > 2)
+        return Benchmark::PackedPositions(words[1], words[2], GetOption("threads", maxThreads)) ? 0 : 1;
+
+    if (command == "perftsuite") {
+        int maxDepth = 5;
+        if (words.size() > 1 && !ParseDepth(words[1], maxDepth))
+            return PrintUsage();
+        return Perft::RunSuite(maxDepth) ? 0 : 1;
+    }
+
+    return PrintUsage();
+}
+
 
 int main(int argc, char** args) {
-    
+
+#ifdef HEADLESS
+    return RunCommand(argc, args);
+#else
+    if (argc > 1)
+        return RunCommand(argc, args);
+
     Game game;
     game.GameLoop();
 
     return 0;
-}
\ No newline at end of file
+#endif
+}